@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ConcurrentStack.h"
+
+#define NIL UINT32_MAX  // Index meaning "no node"
+
+// A top-of-stack word: the index of the top node in the low 32 bits and a tag in the high 32 bits. The tag
+// goes up on every successful CAS, so a thread that read the top, stalled while the node was popped and
+// pushed back (A-B-A), fails its CAS instead of linking in a stale next index.
+typedef uint64_t TaggedTop;
+
+static inline uint32_t topIndex(TaggedTop top) { return (uint32_t)top; }
+static inline TaggedTop makeTop(uint32_t index, TaggedTop previous) {
+    return ((previous >> 32) + 1) << 32 | index;
+}
+
+// Nodes are never freed while the stack exists, so a thread may still read next from a node another thread
+// has just popped: the stale value is discarded when its CAS fails.
+typedef struct ConcurrentNode {
+    _Atomic uint32_t next;
+    void *data;
+} ConcurrentNode;
+
+typedef struct ConcurrentStackObj {
+    _Atomic TaggedTop top;     // The stack
+    _Atomic TaggedTop free;    // Unused nodes, kept as a second Treiber stack
+    atomic_int length;
+    ConcurrentNode *nodes;
+} ConcurrentStackObj;
+
+// Pops a node index off a tagged list. Returns NIL if it is empty.
+static uint32_t popIndex(ConcurrentStackPtr S, _Atomic TaggedTop *list) {
+    TaggedTop top = atomic_load_explicit(list, memory_order_acquire);
+    for (;;) {
+        uint32_t index = topIndex(top);
+        if (index == NIL) return NIL;
+
+        uint32_t next = atomic_load_explicit(&S->nodes[index].next, memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(list, &top, makeTop(next, top),
+                                                  memory_order_acquire, memory_order_acquire)) {
+            return index;
+        }
+    }
+}
+
+// Pushes a node index onto a tagged list.
+static void pushIndex(ConcurrentStackPtr S, _Atomic TaggedTop *list, uint32_t index) {
+    TaggedTop top = atomic_load_explicit(list, memory_order_relaxed);
+    do {
+        atomic_store_explicit(&S->nodes[index].next, topIndex(top), memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(list, &top, makeTop(index, top),
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Constructor for the ConcurrentStack ADT
+ConcurrentStackPtr createConcurrentStack(int capacity) {
+    if (capacity < 0 || (uint32_t)capacity >= NIL) return NULL;
+
+    ConcurrentStackPtr S = (ConcurrentStackPtr)malloc(sizeof(ConcurrentStackObj));
+    if (S == NULL) return NULL;
+
+    S->nodes = (ConcurrentNode *)malloc((capacity + 1) * sizeof(ConcurrentNode));  // + 1: never malloc(0)
+    if (S->nodes == NULL) {
+        free(S);
+        return NULL;
+    }
+
+    // Every node starts on the free list, in index order
+    for (int i = 0; i < capacity; i++) {
+        atomic_init(&S->nodes[i].next, i + 1 < capacity ? (uint32_t)(i + 1) : NIL);
+        S->nodes[i].data = NULL;
+    }
+    atomic_init(&S->top, (TaggedTop)NIL);
+    atomic_init(&S->free, (TaggedTop)(capacity > 0 ? 0 : NIL));
+    atomic_init(&S->length, 0);
+    return S;
+}
+
+// Destructor for the ConcurrentStack ADT
+void destroyConcurrentStack(ConcurrentStackPtr *pS) {
+    if (pS && *pS) {
+        free((*pS)->nodes);
+        free(*pS);
+        *pS = NULL;
+    }
+}
+
+// Returns the length of the stack
+int lengthConcurrentStack(ConcurrentStackPtr S) {
+    if (S == NULL) return -1;
+    return atomic_load_explicit(&S->length, memory_order_relaxed);
+}
+
+// Pushes an entry onto the stack: take a free node, fill it in, then publish it with a release CAS
+bool pushConcurrentStack(ConcurrentStackPtr S, void *data) {
+    if (S == NULL) return false;
+
+    uint32_t index = popIndex(S, &S->free);
+    if (index == NIL) return false;
+
+    S->nodes[index].data = data;
+    pushIndex(S, &S->top, index);
+    atomic_fetch_add_explicit(&S->length, 1, memory_order_relaxed);
+    return true;
+}
+
+// Pops the entry from the top of the stack and returns the data from that entry
+void *popConcurrentStack(ConcurrentStackPtr S) {
+    if (S == NULL) return NULL;
+
+    uint32_t index = popIndex(S, &S->top);
+    if (index == NIL) return NULL;
+
+    // The node is ours until it goes back on the free list
+    void *data = S->nodes[index].data;
+    pushIndex(S, &S->free, index);
+    atomic_fetch_sub_explicit(&S->length, 1, memory_order_relaxed);
+    return data;
+}
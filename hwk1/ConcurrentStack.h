@@ -0,0 +1,63 @@
+#ifndef CONCURRENT_STACK_H
+#define CONCURRENT_STACK_H
+
+#include <stdbool.h>
+//----------------------------------------------------
+// ConcurrentStack.h
+// Header file for the lock-free concurrent Stack ADT
+// ---------------------------------------------------
+
+typedef struct ConcurrentStackObj* ConcurrentStackPtr;
+
+// Constructors-Destructors --------------------------
+
+/**
+ * @brief Creates a stack that any number of threads can push to and pop from at once without locks
+ * (a Treiber stack). Entries live in a node array allocated up front, so the stack holds at most capacity
+ * entries and pushing never allocates.
+ * 
+ * @param capacity Maximum number of entries
+ * @return ConcurrentStackPtr Pointer to the newly created stack, or NULL on allocation failure
+ */
+ConcurrentStackPtr createConcurrentStack(int capacity);
+
+/**
+ * @brief Frees the space taken up by the stack. No other thread may be using it.
+ * 
+ * @param pS A pointer to the ConcurrentStackPtr to deallocate.
+ *           The pointer should be set to NULL!
+ */
+void destroyConcurrentStack(ConcurrentStackPtr *pS);
+
+// Access functions ----------------------------------
+
+/**
+ * @brief Gets the length of a stack. While other threads push and pop, this is a snapshot that may
+ * already be out of date.
+ * 
+ * @param S The stack for which the length should be returned.
+ * @return int The length of the stack, or -1 if error
+ */
+int lengthConcurrentStack(ConcurrentStackPtr S);
+
+// Manipulation functions ----------------------------
+
+/**
+ * @brief Pushes an entry onto the stack. Safe to call from several threads at once.
+ * 
+ * @param S The stack to push onto
+ * @param data The data to add as new entry on the stack
+ * @return bool True if the push was successful, False if the stack is full
+ */
+bool pushConcurrentStack(ConcurrentStackPtr S, void *data);
+
+/**
+ * @brief Pops the entry from the top of the stack and returns the data from that entry. Safe to call from
+ * several threads at once.
+ * 
+ * @param S The stack to pop the entry from.
+ * @return void* The data that was stored in the top entry. Returns NULL if the stack is empty.
+ */
+void *popConcurrentStack(ConcurrentStackPtr S);
+
+#endif // CONCURRENT_STACK_H
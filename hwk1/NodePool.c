@@ -0,0 +1,278 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "NodePool.h"
+
+// Items the pool hands out, one size class each. Every class has its own slabs, freelists and shared list,
+// so a list chunk never takes a node's place or the other way round.
+enum {
+    NODE_CLASS,
+#ifdef LIST_UNROLLED
+    CHUNK_CLASS,
+#endif
+    POOL_CLASSES
+};
+
+// A free item of any class: the first word links it into a freelist
+typedef struct FreeItem {
+    struct FreeItem *next;
+} FreeItem;
+
+// A block of NODE_POOL_SLAB items of one class. Slabs are only freed together, by nodePoolDestroy.
+typedef struct Slab {
+    struct Slab *next;
+    max_align_t items[];  // NODE_POOL_SLAB items of the class's size
+} Slab;
+
+// Shared state of a size class
+typedef struct PoolClass {
+    size_t itemSize;
+    
+    // Every slab, for nodePoolDestroy. While the pool is in use slabs are only ever pushed, so a plain CAS
+    // push is safe (no ABA).
+    _Atomic(Slab *) slabs;
+    
+    // Items handed over by threads whose freelist grew past NODE_POOL_LOCAL_MAX or that exited, for any
+    // thread to take back in runs of up to NODE_POOL_SLAB. Only touched once per NODE_POOL_SLAB items, so a
+    // mutex is cheap enough.
+    pthread_mutex_t sharedLock;
+    FreeItem *sharedList;
+    atomic_long sharedCount;  // Read without the lock to skip it when the list is empty
+} PoolClass;
+
+static PoolClass classes[POOL_CLASSES] = {
+    [NODE_CLASS] = {sizeof(NodeObj), NULL, PTHREAD_MUTEX_INITIALIZER, NULL, 0},
+#ifdef LIST_UNROLLED
+    [CHUNK_CLASS] = {sizeof(ListChunk), NULL, PTHREAD_MUTEX_INITIALIZER, NULL, 0},
+#endif
+};
+
+static atomic_long slabCount = 0;  // Slabs of all classes
+
+// Bumped by nodePoolDestroy. A thread whose state is from an older generation drops it, since its freelist
+// and slab point into freed memory.
+static atomic_int generation = 0;
+
+// Its destructor hands an exiting thread's items to the shared lists
+static pthread_key_t exitKey;
+static pthread_once_t exitKeyOnce = PTHREAD_ONCE_INIT;
+
+// Per-thread state of a size class: no locking on the alloc/free paths
+typedef struct ThreadCache {
+    FreeItem *freeList;
+    FreeItem *freeTail;  // Last item of freeList
+    long freeCount;      // Items on freeList
+    Slab *currentSlab;
+    int carved;          // Items handed out from currentSlab
+    long hits;
+    long misses;
+    long frees;
+    long handedOver;
+} ThreadCache;
+
+static _Thread_local ThreadCache caches[POOL_CLASSES];
+static _Thread_local bool exitRegistered = false;  // exitKey is set for this thread
+static _Thread_local int threadGeneration = -1;    // Never a real generation, so the caches start reset
+
+// Forgets this thread's freelists, slabs and counters if the pool was destroyed since the thread last used
+// it (or the thread has not used it yet)
+static void syncGeneration(void) {
+    int current = atomic_load_explicit(&generation, memory_order_acquire);
+    if (threadGeneration != current) {
+        for (int c = 0; c < POOL_CLASSES; c++) {
+            caches[c] = (ThreadCache){.carved = NODE_POOL_SLAB};
+        }
+        threadGeneration = current;
+    }
+}
+
+// Moves the chain first..last of count items onto the class's shared list
+static void handOver(int c, FreeItem *first, FreeItem *last, long count) {
+    PoolClass *pool = &classes[c];
+    pthread_mutex_lock(&pool->sharedLock);
+    last->next = pool->sharedList;
+    pool->sharedList = first;
+    atomic_store_explicit(&pool->sharedCount,
+                          atomic_load_explicit(&pool->sharedCount, memory_order_relaxed) + count,
+                          memory_order_relaxed);
+    pthread_mutex_unlock(&pool->sharedLock);
+    caches[c].handedOver += count;
+}
+
+// Refills the class's empty freelist with up to NODE_POOL_SLAB items from its shared list
+static void takeShared(int c) {
+    PoolClass *pool = &classes[c];
+    ThreadCache *cache = &caches[c];
+    if (atomic_load_explicit(&pool->sharedCount, memory_order_relaxed) == 0) return;
+    
+    pthread_mutex_lock(&pool->sharedLock);
+    if (pool->sharedList != NULL) {
+        FreeItem *last = pool->sharedList;
+        long count = 1;
+        while (count < NODE_POOL_SLAB && last->next != NULL) {
+            last = last->next;
+            count++;
+        }
+        cache->freeList = pool->sharedList;
+        cache->freeTail = last;
+        cache->freeCount = count;
+        pool->sharedList = last->next;
+        last->next = NULL;
+        atomic_store_explicit(&pool->sharedCount,
+                              atomic_load_explicit(&pool->sharedCount, memory_order_relaxed) - count,
+                              memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&pool->sharedLock);
+}
+
+static void *slabItem(int c, Slab *slab, int i) {
+    return (char *)slab->items + (size_t)i * classes[c].itemSize;
+}
+
+static void poolFree(int c, void *item);
+
+// Thread exit: hand each freelist and each slab's uncarved items to the shared lists, so they are not lost
+static void flushAtExit(void *unused) {
+    (void)unused;
+    syncGeneration();  // State from before a nodePoolDestroy points into freed slabs
+    
+    for (int c = 0; c < POOL_CLASSES; c++) {
+        ThreadCache *cache = &caches[c];
+        while (cache->carved < NODE_POOL_SLAB) {
+            poolFree(c, slabItem(c, cache->currentSlab, cache->carved++));
+        }
+        if (cache->freeList != NULL) {
+            handOver(c, cache->freeList, cache->freeTail, cache->freeCount);
+            cache->freeList = cache->freeTail = NULL;
+            cache->freeCount = 0;
+        }
+    }
+}
+
+static void createExitKey(void) {
+    pthread_key_create(&exitKey, flushAtExit);
+}
+
+// Arranges for flushAtExit to run when the calling thread exits. Called whenever the thread may come to
+// hold items: on a free, a refill from a shared list or a new slab.
+static void registerExit(void) {
+    if (exitRegistered) return;
+    pthread_once(&exitKeyOnce, createExitKey);
+    pthread_setspecific(exitKey, &exitRegistered);  // Any non-NULL value runs the destructor
+    exitRegistered = true;
+}
+
+static void *poolAlloc(int c) {
+    syncGeneration();
+    ThreadCache *cache = &caches[c];
+    
+    if (cache->freeList == NULL) {
+        registerExit();
+        takeShared(c);
+    }
+    if (cache->freeList != NULL) {
+        FreeItem *item = cache->freeList;
+        cache->freeList = item->next;
+        if (cache->freeList == NULL) cache->freeTail = NULL;
+        cache->freeCount--;
+        cache->hits++;
+        return item;
+    }
+    
+    // Freelist empty: carve the next item from the thread's slab, starting a new slab when it runs out
+    if (cache->carved == NODE_POOL_SLAB) {
+        PoolClass *pool = &classes[c];
+        Slab *slab = (Slab *)malloc(offsetof(Slab, items) + NODE_POOL_SLAB * pool->itemSize);
+        if (slab == NULL) return NULL;
+    
+        slab->next = atomic_load_explicit(&pool->slabs, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&pool->slabs, &slab->next, slab,
+                                                      memory_order_release, memory_order_relaxed)) {
+        }
+        atomic_fetch_add_explicit(&slabCount, 1, memory_order_relaxed);
+        cache->currentSlab = slab;
+        cache->carved = 0;
+    }
+    cache->misses++;
+    return slabItem(c, cache->currentSlab, cache->carved++);
+}
+
+static void poolFree(int c, void *item) {
+    if (item == NULL) return;
+    syncGeneration();
+    ThreadCache *cache = &caches[c];
+    
+    registerExit();
+    
+    FreeItem *freed = item;
+    freed->next = cache->freeList;
+    cache->freeList = freed;
+    if (cache->freeTail == NULL) cache->freeTail = freed;
+    cache->freeCount++;
+    cache->frees++;
+    
+    // A thread that frees more than it allocates (a consumer) keeps its newest NODE_POOL_SLAB items and
+    // hands the rest over, so its freelist cannot grow without bound
+    if (cache->freeCount > NODE_POOL_LOCAL_MAX) {
+        FreeItem *keep = cache->freeList;
+        for (int i = 1; i < NODE_POOL_SLAB; i++) {
+            keep = keep->next;
+        }
+        handOver(c, keep->next, cache->freeTail, cache->freeCount - NODE_POOL_SLAB);
+        keep->next = NULL;
+        cache->freeTail = keep;
+        cache->freeCount = NODE_POOL_SLAB;
+    }
+}
+
+NodePtr nodePoolAlloc(void) {
+    return poolAlloc(NODE_CLASS);
+}
+
+void nodePoolFree(NodePtr node) {
+    poolFree(NODE_CLASS, node);
+}
+
+#ifdef LIST_UNROLLED
+ListChunk *chunkPoolAlloc(void) {
+    return poolAlloc(CHUNK_CLASS);
+}
+
+void chunkPoolFree(ListChunk *chunk) {
+    poolFree(CHUNK_CLASS, chunk);
+}
+#endif
+
+void nodePoolStats(NodePoolStats *stats) {
+    if (stats == NULL) return;
+    syncGeneration();
+    *stats = (NodePoolStats){0};
+    for (int c = 0; c < POOL_CLASSES; c++) {
+        stats->hits += caches[c].hits;
+        stats->misses += caches[c].misses;
+        stats->frees += caches[c].frees;
+        stats->handedOver += caches[c].handedOver;
+    }
+    stats->slabs = atomic_load_explicit(&slabCount, memory_order_relaxed);
+}
+
+void nodePoolDestroy(void) {
+    for (int c = 0; c < POOL_CLASSES; c++) {
+        PoolClass *pool = &classes[c];
+        Slab *slab = atomic_exchange_explicit(&pool->slabs, NULL, memory_order_acquire);
+        while (slab != NULL) {
+            Slab *next = slab->next;
+            free(slab);
+            slab = next;
+        }
+        pthread_mutex_lock(&pool->sharedLock);
+        pool->sharedList = NULL;
+        atomic_store_explicit(&pool->sharedCount, 0, memory_order_relaxed);
+        pthread_mutex_unlock(&pool->sharedLock);
+    }
+    atomic_store_explicit(&slabCount, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&generation, 1, memory_order_release);
+    syncGeneration();
+}
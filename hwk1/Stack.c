@@ -4,8 +4,11 @@
 #include <stdbool.h>
 #include "Stack.h"
 #include "List.h"
+#include "NodePool.h"
 #include <assert.h>
 
+#ifndef STACK_ARRAY  // ArrayStack.c implements Stack.h instead
+
 // Constructor for the Stack ADT
 StackPtr createStack(void (*dataPrinter)(void *data)) {
     StackPtr S = (StackPtr)malloc(sizeof(StackObj));
@@ -23,7 +26,7 @@ void destroyStack(StackPtr *pS) {
         NodePtr current = (*pS)->top;
         while (current != NULL) {
             NodePtr next = current->next;
-            free(current);
+            nodePoolFree(current);
             current = next;
         }
         free(*pS);
@@ -58,7 +61,7 @@ void *peekStack(StackPtr S) {
 bool pushStack(StackPtr S, void *data) {
     if (S == NULL) return false;
     
-    NodePtr newNode = (NodePtr)malloc(sizeof(NodeObj));
+    NodePtr newNode = nodePoolAlloc();
     if (newNode == NULL) return false;
     
     newNode->data = data;
@@ -76,8 +79,20 @@ void *popStack(StackPtr S) {
     NodePtr temp = S->top;
     void *data = temp->data;
     S->top = temp->next;
-    free(temp);
+    nodePoolFree(temp);
     S->length--;
     
     return data;
 }
+
+// Nodes are allocated per push, so there is no room to reserve
+bool reserveStack(StackPtr S, int capacity) {
+    return S != NULL && capacity >= 0;
+}
+
+// Nothing to shrink: the stack holds exactly one node per entry
+void shrinkStack(StackPtr S) {
+    (void)S;
+}
+
+#endif
@@ -0,0 +1,333 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime and strdup under -std=c11
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "List.h"
+#include "Stack.h"
+#include "NodePool.h"
+#include "ConcurrentStack.h"
+
+//----------------------------------------------------
+// bench.c
+// Timing benchmarks for the List and Stack ADTs. Build with optimization, once per implementation:
+//   make bench CFLAGS="-O2"
+//   make clean && make bench CFLAGS="-O2 -DLIST_UNROLLED -DSTACK_ARRAY"
+//   ./bench load [words]
+//   ./bench list [entries]
+//   ./bench stack [entries]
+//   ./bench concurrent [operations]
+// ---------------------------------------------------
+
+#define LOAD_WORDS 1000000    // Words in the generated file of the load benchmark
+#define WORDS_PER_LINE 8      // Words per line of that file
+#define MAX_LINE_LEN 1024     // Longest line read back
+#define LIST_ENTRIES 1000000  // Entries in the list benchmark
+#define GETS 2000             // Random getList calls timed; each walks to its index
+#define PASSES 10             // Cursor traversals timed
+#define STACK_ENTRIES 1000000 // Depth the stack benchmark pushes to
+#define ROUNDS 10             // Push/pop rounds timed after the first
+#define THREADED_OPS 4000000  // Pushes and pops in the concurrent benchmark, split between the threads
+#define MAX_THREADS 32        // Thread counts run are 1, 2, 4, ... MAX_THREADS
+#define BATCH 8               // Entries each thread pushes before popping as many
+
+// Seconds on a monotonic clock
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Deterministic pseudo-random numbers (xorshift64), so runs are comparable
+uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Writes n random words, WORDS_PER_LINE to a line, to a temporary file and rewinds it
+FILE *make_word_file(int n) {
+    FILE *fp = tmpfile();
+    if (fp == NULL) {
+        perror("make_word_file");
+        exit(1);
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < n; i++) {
+        fprintf(fp, "w%llx%c", (unsigned long long)(next_random(&state) % 1000000),
+                i % WORDS_PER_LINE == WORDS_PER_LINE - 1 ? '\n' : ' ');
+    }
+    rewind(fp);
+    return fp;
+}
+
+// Name of the List implementation this was built with
+const char *list_kind(void) {
+#ifdef LIST_UNROLLED
+    return "unrolled";
+#else
+    return "linked";
+#endif
+}
+
+// Name of the Stack implementation this was built with
+const char *stack_kind(void) {
+#ifdef STACK_ARRAY
+    return "array";
+#else
+    return "linked";
+#endif
+}
+
+// Reads the word file into L, one appendList per word, or one extendList per line. Returns the seconds
+// spent in appendList/extendList alone through list_time.
+void load_words(FILE *fp, ListPtr L, bool extend, double *list_time) {
+    char line[MAX_LINE_LEN];
+    void *words[MAX_LINE_LEN / 2];
+    *list_time = 0;
+    rewind(fp);
+    while (fgets(line, sizeof(line), fp)) {
+        int n = 0;
+        for (char *word = strtok(line, " \n"); word; word = strtok(NULL, " \n")) {
+            words[n++] = strdup(word);
+        }
+        double start = now();
+        if (extend) {
+            extendList(L, words, n);
+        } else {
+            for (int i = 0; i < n; i++) {
+                appendList(L, words[i]);
+            }
+        }
+        *list_time += now() - start;
+    }
+}
+
+// Frees the words of a loaded list and the list itself
+void free_words(ListPtr *pL) {
+    ListCursor C;
+    for (beginList(*pL, &C); !endList(&C); nextList(&C)) {
+        free(currentList(&C));
+    }
+    destroyList(pL);
+}
+
+// Loads an n-word file into a list with appendList and with extendList: the whole load (reading, copying
+// the words, building the list) and the list operations alone
+void bench_load(int n) {
+    FILE *fp = make_word_file(n);
+    printf("Loading a %d-word file (%s list), ns per word\n", n, list_kind());
+    printf("  %-12s %10s %10s\n", "", "load", "list ops");
+    for (int extend = 0; extend <= 1; extend++) {
+        ListPtr L = createList(NULL);
+        double list_time;
+        double start = now();
+        load_words(fp, L, extend, &list_time);
+        double total = now() - start;
+        if (lengthList(L) != n) {
+            printf("Loaded %d words, expected %d\n", lengthList(L), n);
+            exit(1);
+        }
+        printf("  %-12s %10.1f %10.1f\n", extend ? "extendList" : "appendList", total * 1e9 / n,
+               list_time * 1e9 / n);
+        free_words(&L);
+    }
+    fclose(fp);
+}
+
+// Appends n entries, then times random indexed gets and full cursor traversals
+void bench_list(int n) {
+    int *values = malloc(n * sizeof(int));
+    if (values == NULL) {
+        perror("bench_list");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        values[i] = i;
+    }
+
+    ListPtr L = createList(NULL);
+    double start = now();
+    for (int i = 0; i < n; i++) {
+        appendList(L, &values[i]);
+    }
+    double append = now() - start;
+
+    uint64_t state = 88172645463325252ULL;
+    long sum = 0;
+    start = now();
+    for (int i = 0; i < GETS; i++) {
+        sum += *(int *)getList(L, next_random(&state) % n);
+    }
+    double get = now() - start;
+
+    ListCursor C;
+    start = now();
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (beginList(L, &C); !endList(&C); nextList(&C)) {
+            sum += *(int *)currentList(&C);
+        }
+    }
+    double traverse = now() - start;
+
+    printf("%d entries (%s list, checksum %ld)\n", n, list_kind(), sum);
+    printf("  append     %8.1f ns per entry\n", append * 1e9 / n);
+    printf("  getList    %8.1f us per call (random index)\n", get * 1e6 / GETS);
+    printf("  traversal  %8.1f ns per entry (cursor)\n", traverse * 1e9 / PASSES / n);
+
+    destroyList(&L);
+    free(values);
+}
+
+// Pushes n entries onto a stack and pops them all: once on a new stack, where the linked stack carves
+// fresh pool slabs and the array stack grows, then ROUNDS more times reusing the nodes or the array
+void bench_stack(int n) {
+    int *values = malloc(n * sizeof(int));
+    if (values == NULL) {
+        perror("bench_stack");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        values[i] = i;
+    }
+
+    StackPtr S = createStack(NULL);
+    long sum = 0;
+    double push[2] = {0, 0}, pop[2] = {0, 0};  // [0]: first round, [1]: the rest
+    for (int round = 0; round <= ROUNDS; round++) {
+        int later = round > 0;
+        double start = now();
+        for (int i = 0; i < n; i++) {
+            pushStack(S, &values[i]);
+        }
+        push[later] += now() - start;
+
+        start = now();
+        for (int i = 0; i < n; i++) {
+            sum += *(int *)popStack(S);
+        }
+        pop[later] += now() - start;
+    }
+
+    printf("%d entries (%s stack, checksum %ld), ns per operation\n", n, stack_kind(), sum);
+    printf("  %-12s %10s %10s\n", "", "push", "pop");
+    printf("  %-12s %10.1f %10.1f\n", "first round", push[0] * 1e9 / n, pop[0] * 1e9 / n);
+    printf("  %-12s %10.1f %10.1f\n", "later rounds", push[1] * 1e9 / ROUNDS / n,
+           pop[1] * 1e9 / ROUNDS / n);
+
+    destroyStack(&S);
+    free(values);
+}
+
+// Shared by the threads of one concurrent run. Exactly one of stack and locked is used.
+typedef struct ConcurrentRun {
+    ConcurrentStackPtr stack;  // Lock-free stack
+    StackPtr locked;           // Plain stack behind lock
+    pthread_mutex_t lock;
+    pthread_barrier_t start;   // Releases the threads and the timer together
+    int ops;                   // Pushes and pops per thread
+    int value;                 // What gets pushed; only the pointer is used
+} ConcurrentRun;
+
+// Pushes BATCH entries, then pops BATCH, until ops operations are done. The stack cannot run dry: this
+// thread pushed BATCH entries more than it popped before each pop.
+void *concurrent_worker(void *arg) {
+    ConcurrentRun *run = arg;
+    pthread_barrier_wait(&run->start);
+    for (int done = 0; done < run->ops; done += 2 * BATCH) {
+        for (int i = 0; i < BATCH; i++) {
+            if (run->stack) {
+                pushConcurrentStack(run->stack, &run->value);
+            } else {
+                pthread_mutex_lock(&run->lock);
+                pushStack(run->locked, &run->value);
+                pthread_mutex_unlock(&run->lock);
+            }
+        }
+        for (int i = 0; i < BATCH; i++) {
+            if (run->stack) {
+                popConcurrentStack(run->stack);
+            } else {
+                pthread_mutex_lock(&run->lock);
+                popStack(run->locked);
+                pthread_mutex_unlock(&run->lock);
+            }
+        }
+    }
+    return NULL;
+}
+
+// Runs threads workers on the lock-free stack or on the locked one; returns the seconds taken
+double concurrent_run(int threads, int total_ops, bool lock_free) {
+    ConcurrentRun run;
+    run.stack = lock_free ? createConcurrentStack(threads * BATCH) : NULL;
+    run.locked = lock_free ? NULL : createStack(NULL);
+    pthread_mutex_init(&run.lock, NULL);
+    pthread_barrier_init(&run.start, NULL, threads + 1);
+    run.ops = total_ops / threads;
+    run.value = 0;
+
+    pthread_t workers[MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&workers[t], NULL, concurrent_worker, &run);
+    }
+    pthread_barrier_wait(&run.start);
+    double start = now();
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    double elapsed = now() - start;
+
+    destroyConcurrentStack(&run.stack);
+    destroyStack(&run.locked);
+    pthread_barrier_destroy(&run.start);
+    pthread_mutex_destroy(&run.lock);
+    return elapsed;
+}
+
+// Throughput of the lock-free ConcurrentStack against a Stack behind one mutex, as the thread count goes
+// up with the total work fixed
+void bench_concurrent(int total_ops) {
+    printf("%d pushes and pops in batches of %d, millions of operations per second\n", total_ops, BATCH);
+    printf("  %-8s %12s %12s\n", "threads", "lock-free", "mutex");
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        int ops = total_ops / threads / (2 * BATCH) * (2 * BATCH) * threads;  // Whole batches per thread
+        double lock_free = concurrent_run(threads, ops, true);
+        double locked = concurrent_run(threads, ops, false);
+        printf("  %-8d %12.1f %12.1f\n", threads, ops / lock_free / 1e6, ops / locked / 1e6);
+    }
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 2 ? atoi(argv[2]) : 0;
+
+    if (argc > 1 && strcmp(argv[1], "load") == 0) {
+        bench_load(n > 0 ? n : LOAD_WORDS);
+        nodePoolDestroy();
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "list") == 0) {
+        bench_list(n > 0 ? n : LIST_ENTRIES);
+        nodePoolDestroy();
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "stack") == 0) {
+        bench_stack(n > 0 ? n : STACK_ENTRIES);
+        nodePoolDestroy();
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "concurrent") == 0) {
+        bench_concurrent(n > 0 ? n : THREADED_OPS);
+        nodePoolDestroy();
+        return 0;
+    }
+
+    printf("Usage: %s load|list|stack|concurrent [count]\n", argv[0]);
+    return 1;
+}
@@ -1,7 +1,22 @@
 #include "Stack.h"
 #include "List.h"
+#include "NodePool.h"
+#include "ConcurrentStack.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define STRESS_PRODUCERS 4
+#define STRESS_CONSUMERS 4
+#define STRESS_ITEMS 200000	// Split evenly between the producers
+#define STRESS_CAPACITY 64	// Small, so the stack keeps filling up and emptying under contention
+#define EXTEND_ITEMS 64		// Entries in the extendList test, several unrolled chunks' worth
+#define CURSOR_ITEMS 100	// Entries in the cursor test, 0..99
+#define POOL_LISTS 20000	// Lists passed from one thread to another in the node pool test
+#define POOL_LIST_ENTRIES 14	// Entries per list: 14 nodes, or one unrolled chunk
+#define RESERVE_ITEMS 1000	// Entries in the reserve/shrink test, 0..999
 
 void printNumber( void *num )
 {
@@ -15,6 +30,137 @@ void printString( void *str )
 	printf( "%s    ", s );	// print string starting from s
 }
 
+// Checks that L holds &values[first], &values[first + step], ... (count entries), both through a cursor
+// and through getList
+bool holdsSequence( ListPtr L, int *values, int first, int step, int count )
+{
+	ListCursor C;
+	int i = 0;
+	for( beginList( L, &C ); !endList( &C ); nextList( &C ), i++ ) {
+	    if (i == count || currentList( &C ) != &values[first + i * step]) return false;
+	    if (getList( L, i ) != currentList( &C )) return false;
+	}
+	return i == count && lengthList( L ) == count;
+}
+
+// Walks L with a cursor and deletes every entry whose value is not a multiple of keep. Returns false if
+// deleteCurrentList hands back anything but the entry under the cursor.
+bool deleteWhileWalking( ListPtr L, int keep )
+{
+	ListCursor C;
+	bool ok = true;
+	beginList( L, &C );
+	while( !endList( &C ) ) {
+	    int *item = currentList( &C );
+	    if (*item % keep != 0)
+		ok = ok && deleteCurrentList( &C ) == item;
+	    else
+		nextList( &C );
+	}
+	return ok && deleteCurrentList( &C ) == NULL;	// Nothing left to delete at the end
+}
+
+// Pops count entries off S and checks that they are &values[top], &values[top - 1], ...
+bool popsSequence( StackPtr S, int *values, int top, int count )
+{
+	for( int i = 0; i < count; i++ ) {
+	    if (popStack( S ) != &values[top - i]) return false;
+	}
+	return true;
+}
+
+// Shared by the threads of the concurrent stack stress test
+typedef struct StressTest {
+	ConcurrentStackPtr stack;
+	int items[STRESS_ITEMS];		// items[i] == i; the stack holds pointers into this array
+	atomic_int popCount[STRESS_ITEMS];	// How many times each item was popped
+	atomic_int popped;			// Total pops so far
+	atomic_int nextProducer;
+} StressTest;
+
+void *stressProducer( void *arg )
+{
+	StressTest *test = arg;
+	int id = atomic_fetch_add( &test->nextProducer, 1 );
+	int per = STRESS_ITEMS / STRESS_PRODUCERS;
+
+	for( int i = id * per; i < (id + 1) * per; i++ ) {
+	    while( !pushConcurrentStack( test->stack, &test->items[i] ) )
+		sched_yield();		// full: wait for a consumer
+	}
+	return NULL;
+}
+
+void *stressConsumer( void *arg )
+{
+	StressTest *test = arg;
+
+	while( atomic_load( &test->popped ) < STRESS_ITEMS ) {
+	    int *item = popConcurrentStack( test->stack );
+	    if (item == NULL) {
+		sched_yield();		// empty: wait for a producer
+		continue;
+	    }
+	    atomic_fetch_add( &test->popCount[*item], 1 );
+	    atomic_fetch_add( &test->popped, 1 );
+	}
+	return NULL;
+}
+
+// Shared by the two threads of the node pool test: one builds lists and hands them over through a
+// concurrent stack, the other destroys them, so pool items (nodes, or chunks in the unrolled build) keep
+// moving between the threads' freelists
+typedef struct PoolTest {
+	ConcurrentStackPtr handoff;
+	int value;			// What every list entry points to
+	NodePoolStats consumer;		// The consumer's counters, taken before it exits
+} PoolTest;
+
+void *poolProducer( void *arg )
+{
+	PoolTest *test = arg;
+
+	for( int i = 0; i < POOL_LISTS; i++ ) {
+	    ListPtr L = createList( printNumber );
+	    for( int j = 0; j < POOL_LIST_ENTRIES; j++ )
+		appendList( L, &test->value );
+	    while( !pushConcurrentStack( test->handoff, L ) )
+		sched_yield();		// full: wait for the consumer
+	}
+	return NULL;
+}
+
+void *poolConsumer( void *arg )
+{
+	PoolTest *test = arg;
+
+	for( int i = 0; i < POOL_LISTS; ) {
+	    ListPtr L = popConcurrentStack( test->handoff );
+	    if (L == NULL) {
+		sched_yield();		// empty: wait for the producer
+		continue;
+	    }
+	    destroyList( &L );
+	    i++;
+	}
+	nodePoolStats( &test->consumer );
+	return NULL;
+}
+
+// Runs one producer and one consumer to completion; returns the number of slabs they allocated
+long runPoolThreads( PoolTest *test )
+{
+	NodePoolStats before, after;
+	nodePoolStats( &before );
+	pthread_t producer, consumer;
+	pthread_create( &producer, NULL, poolProducer, test );
+	pthread_create( &consumer, NULL, poolConsumer, test );
+	pthread_join( producer, NULL );
+	pthread_join( consumer, NULL );
+	nodePoolStats( &after );
+	return after.slabs - before.slabs;
+}
+
 int main(int argc, char **argv){
 
 
@@ -138,6 +284,64 @@ int main(int argc, char **argv){
 	
 	destroyList(&testList);
 
+	// Test extendList: an empty extend, a bulk extend spanning many nodes, an append in between, an
+	// extend onto a partly filled tail, and bad arguments that must leave the list alone
+	printf("\nTesting extendList function:\n");
+	int values[EXTEND_ITEMS];
+	void *items[EXTEND_ITEMS];
+	for (int i = 0; i < EXTEND_ITEMS; i++) {
+	    values[i] = i;
+	    items[i] = &values[i];
+	}
+	ListPtr extended = createList(printNumber);
+	bool extendOk = extendList(extended, items, 0) && lengthList(extended) == 0;
+	extendOk = extendOk && extendList(extended, items, 40);
+	extendOk = extendOk && appendList(extended, items[40]);
+	extendOk = extendOk && extendList(extended, items + 41, EXTEND_ITEMS - 41);
+	extendOk = extendOk && !extendList(extended, NULL, 5) && !extendList(extended, items, -1);
+	extendOk = extendOk && lengthList(extended) == EXTEND_ITEMS;
+	for (int i = 0; extendOk && i < EXTEND_ITEMS; i++)
+	    extendOk = getList(extended, i) == items[i];
+	printf("Extending by 0, then 40, appending 1, extending by %d: %d elements in order -- %s\n",
+	       EXTEND_ITEMS - 41, lengthList(extended), extendOk ? "correct" : "INCORRECT");
+	destroyList(&extended);
+
+	// Test the list cursor. The first pass leaves every chunk of the unrolled list sparse, so deletes in
+	// the second pass merge chunks under the cursor; the last two delete the tail entry and then every
+	// entry, and appends afterwards check that the tail was kept up to date
+	printf("\nTesting the list cursor:\n");
+	int walkValues[CURSOR_ITEMS];
+	ListPtr walked = createList(printNumber);
+	for (int i = 0; i < CURSOR_ITEMS; i++) {
+	    walkValues[i] = i;
+	    appendList(walked, &walkValues[i]);
+	}
+	bool cursorOk = deleteWhileWalking(walked, 3) && holdsSequence(walked, walkValues, 0, 3, 34);
+	printf("Deleting every entry not divisible by 3 while walking: %d left in order -- %s\n",
+	       lengthList(walked), cursorOk ? "correct" : "INCORRECT");
+
+	cursorOk = deleteWhileWalking(walked, 6) && holdsSequence(walked, walkValues, 0, 6, 17);
+	printf("Deleting every entry not divisible by 6 while walking: %d left in order -- %s\n",
+	       lengthList(walked), cursorOk ? "correct" : "INCORRECT");
+
+	ListCursor cursor;
+	beginList(walked, &cursor);
+	for (int i = 0; i < lengthList(walked) - 1; i++)
+	    nextList(&cursor);
+	cursorOk = deleteCurrentList(&cursor) == &walkValues[96] && endList(&cursor)
+	        && appendList(walked, &walkValues[96]) && holdsSequence(walked, walkValues, 0, 6, 17);
+	printf("Deleting the last entry, then appending it again: %d elements in order -- %s\n",
+	       lengthList(walked), cursorOk ? "correct" : "INCORRECT");
+
+	cursorOk = true;
+	for (beginList(walked, &cursor); !endList(&cursor); )
+	    cursorOk = cursorOk && deleteCurrentList(&cursor) != NULL;
+	cursorOk = cursorOk && lengthList(walked) == 0 && appendList(walked, &walkValues[0])
+	        && holdsSequence(walked, walkValues, 0, 1, 1);
+	printf("Deleting every entry, then appending one: %d element -- %s\n",
+	       lengthList(walked), cursorOk ? "correct" : "INCORRECT");
+	destroyList(&walked);
+
 	// Test Stack ADT
 	printf("Stack operations:\n");
 	StackPtr myStack = createStack(printNumber);
@@ -163,6 +367,104 @@ int main(int argc, char **argv){
 	printf("\n");
 	
 	destroyStack(&myStack);
+
+	// Test reserveStack and shrinkStack. The array-backed stack must not move its array while pushing
+	// into reserved room, must trim it to the length on a shrink and free it on a shrink when empty; the
+	// linked stack only has to keep its entries intact
+	printf("\nTesting stack reserve and shrink:\n");
+	int stackValues[RESERVE_ITEMS];
+	StackPtr reserved = createStack(printNumber);
+	bool reserveOk = reserveStack(reserved, RESERVE_ITEMS) && reserveStack(reserved, 0);
+	reserveOk = reserveOk && !reserveStack(reserved, -1) && !reserveStack(NULL, 1);
+#ifdef STACK_ARRAY
+	void **reservedItems = reserved->items;
+	reserveOk = reserveOk && reserved->capacity >= RESERVE_ITEMS;
+#endif
+	for (int i = 0; i < RESERVE_ITEMS; i++) {
+	    stackValues[i] = i;
+	    reserveOk = reserveOk && pushStack(reserved, &stackValues[i]);
+	}
+#ifdef STACK_ARRAY
+	reserveOk = reserveOk && reserved->items == reservedItems;
+#endif
+	reserveOk = reserveOk && popsSequence(reserved, stackValues, RESERVE_ITEMS - 1, RESERVE_ITEMS / 2);
+	printf("Reserving %d entries, pushing %d and popping half: %d left -- %s\n", RESERVE_ITEMS,
+	       RESERVE_ITEMS, lengthStack(reserved), reserveOk && lengthStack(reserved) == RESERVE_ITEMS / 2 ?
+	       "correct" : "INCORRECT");
+
+	shrinkStack(reserved);
+	bool shrinkOk = lengthStack(reserved) == RESERVE_ITEMS / 2;
+#ifdef STACK_ARRAY
+	shrinkOk = shrinkOk && reserved->capacity == RESERVE_ITEMS / 2;
+#endif
+	shrinkOk = shrinkOk && popsSequence(reserved, stackValues, RESERVE_ITEMS / 2 - 1, RESERVE_ITEMS / 2);
+	shrinkOk = shrinkOk && lengthStack(reserved) == 0 && popStack(reserved) == NULL;
+	shrinkStack(reserved);
+#ifdef STACK_ARRAY
+	shrinkOk = shrinkOk && reserved->capacity == 0 && reserved->items == NULL;
+#endif
+	shrinkOk = shrinkOk && pushStack(reserved, &stackValues[7]) && peekStack(reserved) == &stackValues[7];
+	printf("Shrinking, popping the rest in order, shrinking when empty, pushing again: %d element -- %s\n",
+	       lengthStack(reserved), shrinkOk && lengthStack(reserved) == 1 ? "correct" : "INCORRECT");
+	destroyStack(&reserved);
+
+	// Test ConcurrentStack ADT: producers and consumers hammer one small stack at once, and every
+	// pushed item must come off it exactly once
+	printf("\nConcurrent stack stress test (%d producers, %d consumers, %d items):\n",
+	       STRESS_PRODUCERS, STRESS_CONSUMERS, STRESS_ITEMS);
+	StressTest *test = malloc(sizeof(StressTest));
+	test->stack = createConcurrentStack(STRESS_CAPACITY);
+	for (int i = 0; i < STRESS_ITEMS; i++) {
+	    test->items[i] = i;
+	    atomic_init(&test->popCount[i], 0);
+	}
+	atomic_init(&test->popped, 0);
+	atomic_init(&test->nextProducer, 0);
+
+	pthread_t threads[STRESS_PRODUCERS + STRESS_CONSUMERS];
+	for (int i = 0; i < STRESS_PRODUCERS + STRESS_CONSUMERS; i++)
+	    pthread_create(&threads[i], NULL, i < STRESS_PRODUCERS ? stressProducer : stressConsumer, test);
+	for (int i = 0; i < STRESS_PRODUCERS + STRESS_CONSUMERS; i++)
+	    pthread_join(threads[i], NULL);
+
+	int lost = 0, duplicated = 0;
+	for (int i = 0; i < STRESS_ITEMS; i++) {
+	    int count = atomic_load(&test->popCount[i]);
+	    if (count == 0) lost++;
+	    if (count > 1) duplicated++;
+	}
+	printf("Items lost: %d, popped more than once: %d, left on the stack: %d -- %s\n",
+	       lost, duplicated, lengthConcurrentStack(test->stack),
+	       lost == 0 && duplicated == 0 && lengthConcurrentStack(test->stack) == 0 ? "correct" : "INCORRECT");
+
+	destroyConcurrentStack(&test->stack);
+	free(test);
+
+	// Test the node pool across threads: the consumer must hand its surplus nodes (or chunks) back instead
+	// of keeping them all, so the producer needs only a few slabs; a second round must need none, since both
+	// threads of the first round hand their items over when they exit
+#ifdef LIST_UNROLLED
+	int poolItems = POOL_LISTS * ((POOL_LIST_ENTRIES + LIST_CHUNK - 1) / LIST_CHUNK);
+#else
+	int poolItems = POOL_LISTS * POOL_LIST_ENTRIES;
+#endif
+	printf("\nNode pool producer/consumer test (%d lists of %d):\n", POOL_LISTS, POOL_LIST_ENTRIES);
+	PoolTest poolTest;
+	poolTest.handoff = createConcurrentStack(STRESS_CAPACITY);
+	poolTest.value = 0;
+	long firstSlabs = runPoolThreads(&poolTest);
+	long kept = poolTest.consumer.frees - poolTest.consumer.handedOver;
+	bool allPooled = poolTest.consumer.frees == poolItems;	// Every item went back to the pool
+	long secondSlabs = runPoolThreads(&poolTest);
+	int unpooledSlabs = poolItems / NODE_POOL_SLAB;	// Needed if nothing was ever recycled
+	printf("Slabs allocated: %ld, then %ld (%d without recycling); consumer kept %s items -- %s\n",
+	       firstSlabs, secondSlabs, unpooledSlabs, kept <= NODE_POOL_LOCAL_MAX ? "few" : "all",
+	       allPooled && firstSlabs * 10 < unpooledSlabs && secondSlabs == 0 && kept <= NODE_POOL_LOCAL_MAX ?
+	       "correct" : "INCORRECT");
+	destroyConcurrentStack(&poolTest.handoff);
+	
+	// Every list and stack is gone: hand the node slabs back
+	nodePoolDestroy();
 	
 	return 0;
 }
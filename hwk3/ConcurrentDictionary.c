@@ -0,0 +1,282 @@
+#include "ConcurrentDictionary.h"
+#include "HashTable.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RECLAIM_THRESHOLD 64  // Retired nodes a stripe collects before it scans the readers
+
+// Chain node. next is atomic so readers can follow it while a writer relinks the chain.
+typedef struct CDictNode {
+    char *key;
+    void *value;
+    _Atomic(struct CDictNode *) next;
+    unsigned long retired_epoch;     // Global epoch when the node was unlinked
+    struct CDictNode *retired_next;  // Next node on its stripe's retire list
+} CDictNode;
+
+// Nodes unlinked by the writers of one stripe, waiting until no reader can still reach them. Guarded by
+// the stripe's writer lock, which a delete holds anyway, so retiring a node takes no other lock.
+typedef struct RetireList {
+    CDictNode *head;
+    int count;
+    int reclaim_at;  // Count that triggers the next reclaim; raised while readers hold nodes back
+} RetireList;
+
+typedef struct ConcurrentDictionary {
+    int slots;
+    int stripes;
+    _Atomic(CDictNode *) *hash_table;
+    pthread_mutex_t *locks;     // Writer lock for slot i is locks[i % stripes]
+    RetireList *retired;        // retired[i] holds the nodes deleted under locks[i]
+    atomic_int size;
+    atomic_ulong epoch;         // Bumped on every retirement
+    atomic_ulong reader_epoch[CDICT_MAX_THREADS];  // Epoch announced by each active reader, 0 if idle
+} ConcurrentDictionary;
+
+// Reader slots are per thread and shared by all concurrent dictionaries. A slot is handed back when its
+// thread exits, through the destructor of a pthread key.
+static atomic_bool slot_used[CDICT_MAX_THREADS];
+static pthread_once_t slot_once = PTHREAD_ONCE_INIT;
+static pthread_key_t slot_key;
+static _Thread_local int thread_slot = -1;
+
+static void release_slot(void *data) {
+    atomic_store(&slot_used[(intptr_t)data - 1], false);
+}
+
+static void create_slot_key(void) {
+    pthread_key_create(&slot_key, release_slot);
+}
+
+// Returns the calling thread's reader slot, claiming one on first use. Returns -1 if all are taken.
+static int reader_slot(void) {
+    if (thread_slot >= 0) return thread_slot;
+    
+    pthread_once(&slot_once, create_slot_key);
+    for (int i = 0; i < CDICT_MAX_THREADS; i++) {
+        bool expected = false;
+        if (atomic_compare_exchange_strong(&slot_used[i], &expected, true)) {
+            thread_slot = i;
+            pthread_setspecific(slot_key, (void *)(intptr_t)(i + 1));
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void free_node(CDictNode *node) {
+    free(node->key);
+    free(node);
+}
+
+// Frees every node on a stripe's retire list that no active reader can still see. A reader that announced
+// an epoch greater than a node's retirement epoch started after the node was unlinked. Caller holds the
+// stripe's writer lock.
+static void reclaim(ConcurrentDictionary *CD, RetireList *list) {
+    // Pairs with the fence in find: either we see a reader's announcement, or it sees our unlink
+    atomic_thread_fence(memory_order_seq_cst);
+    
+    unsigned long oldest = ULONG_MAX;
+    for (int i = 0; i < CDICT_MAX_THREADS; i++) {
+        unsigned long e = atomic_load(&CD->reader_epoch[i]);
+        if (e != 0 && e < oldest) oldest = e;
+    }
+    
+    CDictNode **link = &list->head;
+    while (*link != NULL) {
+        CDictNode *node = *link;
+        if (node->retired_epoch < oldest) {
+            *link = node->retired_next;
+            free_node(node);
+            list->count--;
+        } else {
+            link = &node->retired_next;
+        }
+    }
+    
+    // Nodes a slow reader still holds stay; wait for twice as many before scanning again, so a stalled
+    // reader does not turn every delete into a full scan
+    list->reclaim_at = list->count * 2 > RECLAIM_THRESHOLD ? list->count * 2 : RECLAIM_THRESHOLD;
+}
+
+ConcurrentDictionary *concurrent_dictionary_create(int hash_table_size, int stripes) {
+    if (hash_table_size <= 0) return NULL;
+    if (stripes < 1) stripes = 1;
+    if (stripes > hash_table_size) stripes = hash_table_size;
+    
+    ConcurrentDictionary *CD = calloc(1, sizeof(ConcurrentDictionary));
+    if (CD == NULL) return NULL;
+    
+    CD->slots = hash_table_size;
+    CD->stripes = stripes;
+    CD->hash_table = calloc(hash_table_size, sizeof(*CD->hash_table));
+    CD->locks = malloc(stripes * sizeof(pthread_mutex_t));
+    CD->retired = malloc(stripes * sizeof(RetireList));
+    if (CD->hash_table == NULL || CD->locks == NULL || CD->retired == NULL) {
+        free(CD->hash_table);
+        free(CD->locks);
+        free(CD->retired);
+        free(CD);
+        return NULL;
+    }
+    
+    for (int i = 0; i < hash_table_size; i++) {
+        atomic_init(&CD->hash_table[i], NULL);
+    }
+    for (int i = 0; i < stripes; i++) {
+        pthread_mutex_init(&CD->locks[i], NULL);
+        CD->retired[i].head = NULL;
+        CD->retired[i].count = 0;
+        CD->retired[i].reclaim_at = RECLAIM_THRESHOLD;
+    }
+    atomic_init(&CD->size, 0);
+    atomic_init(&CD->epoch, 1);
+    for (int i = 0; i < CDICT_MAX_THREADS; i++) {
+        atomic_init(&CD->reader_epoch[i], 0);
+    }
+    return CD;
+}
+
+void concurrent_dictionary_destroy(ConcurrentDictionary *CD) {
+    if (CD == NULL) return;
+    
+    for (int i = 0; i < CD->slots; i++) {
+        CDictNode *node = atomic_load_explicit(&CD->hash_table[i], memory_order_relaxed);
+        while (node != NULL) {
+            CDictNode *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+            free_node(node);
+            node = next;
+        }
+    }
+    for (int i = 0; i < CD->stripes; i++) {
+        CDictNode *node = CD->retired[i].head;
+        while (node != NULL) {
+            CDictNode *next = node->retired_next;
+            free_node(node);
+            node = next;
+        }
+        pthread_mutex_destroy(&CD->locks[i]);
+    }
+    free(CD->retired);
+    free(CD->locks);
+    free(CD->hash_table);
+    free(CD);
+}
+
+bool concurrent_dictionary_insert(ConcurrentDictionary *CD, char *key, void *value) {
+    if (CD == NULL || key == NULL) return false;
+    
+    unsigned int index = ht_hash(key, CD->slots);
+    pthread_mutex_t *lock = &CD->locks[index % CD->stripes];
+    
+    CDictNode *node = malloc(sizeof(CDictNode));
+    if (node == NULL) return false;
+    node->key = strdup(key);
+    node->value = value;
+    if (node->key == NULL) {
+        free(node);
+        return false;
+    }
+    
+    pthread_mutex_lock(lock);
+    
+    // Writers on this slot are excluded, so the chain can only change under us by our own hand
+    CDictNode *head = atomic_load_explicit(&CD->hash_table[index], memory_order_relaxed);
+    for (CDictNode *cur = head; cur != NULL; cur = atomic_load_explicit(&cur->next, memory_order_relaxed)) {
+        if (strcmp(cur->key, key) == 0) {
+            pthread_mutex_unlock(lock);
+            free_node(node);
+            return false;
+        }
+    }
+    
+    // Publish the fully initialized node at the head of the chain
+    atomic_store_explicit(&node->next, head, memory_order_relaxed);
+    atomic_store_explicit(&CD->hash_table[index], node, memory_order_release);
+    atomic_fetch_add(&CD->size, 1);
+    
+    pthread_mutex_unlock(lock);
+    return true;
+}
+
+bool concurrent_dictionary_delete(ConcurrentDictionary *CD, char *key, void **value) {
+    if (CD == NULL || key == NULL) return false;
+    
+    unsigned int index = ht_hash(key, CD->slots);
+    int stripe = index % CD->stripes;
+    pthread_mutex_t *lock = &CD->locks[stripe];
+    
+    pthread_mutex_lock(lock);
+    
+    _Atomic(CDictNode *) *link = &CD->hash_table[index];
+    CDictNode *cur = atomic_load_explicit(link, memory_order_relaxed);
+    while (cur != NULL && strcmp(cur->key, key) != 0) {
+        link = &cur->next;
+        cur = atomic_load_explicit(link, memory_order_relaxed);
+    }
+    if (cur == NULL) {
+        pthread_mutex_unlock(lock);
+        return false;
+    }
+    
+    // Unlink; readers already on cur still see a valid next pointer
+    atomic_store_explicit(link, atomic_load_explicit(&cur->next, memory_order_relaxed), memory_order_release);
+    atomic_fetch_sub(&CD->size, 1);
+    if (value != NULL) *value = cur->value;
+    
+    // Retire the node on this stripe's list: it is tagged with the epoch it was unlinked in, and the epoch
+    // moves on. The readers are only scanned once the list has grown, so that cost is spread over many deletes.
+    RetireList *list = &CD->retired[stripe];
+    cur->retired_epoch = atomic_fetch_add(&CD->epoch, 1);
+    cur->retired_next = list->head;
+    list->head = cur;
+    if (++list->count >= list->reclaim_at) {
+        reclaim(CD, list);
+    }
+    
+    pthread_mutex_unlock(lock);
+    return true;
+}
+
+bool concurrent_dictionary_find(ConcurrentDictionary *CD, char *key, void **value) {
+    if (CD == NULL || key == NULL) return false;
+    
+    unsigned int index = ht_hash(key, CD->slots);
+    int slot = reader_slot();
+    bool found = false;
+    
+    // Out of reader slots: fall back to the writer lock, which keeps retired nodes out of reach
+    if (slot < 0) {
+        pthread_mutex_lock(&CD->locks[index % CD->stripes]);
+    } else {
+        // Announce the epoch we start in; the fence orders it before any chain pointer is read
+        atomic_store(&CD->reader_epoch[slot], atomic_load(&CD->epoch));
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+    
+    CDictNode *cur = atomic_load_explicit(&CD->hash_table[index], memory_order_acquire);
+    while (cur != NULL) {
+        if (strcmp(cur->key, key) == 0) {
+            if (value != NULL) *value = cur->value;
+            found = true;
+            break;
+        }
+        cur = atomic_load_explicit(&cur->next, memory_order_acquire);
+    }
+    
+    if (slot < 0) {
+        pthread_mutex_unlock(&CD->locks[index % CD->stripes]);
+    } else {
+        atomic_store_explicit(&CD->reader_epoch[slot], 0, memory_order_release);
+    }
+    return found;
+}
+
+int concurrent_dictionary_size(ConcurrentDictionary *CD) {
+    if (CD == NULL) return 0;
+    return atomic_load(&CD->size);
+}
@@ -0,0 +1,77 @@
+#include <stdbool.h>
+
+#ifndef CONCURRENT_DICT_HEADER
+#define CONCURRENT_DICT_HEADER
+
+typedef struct ConcurrentDictionary ConcurrentDictionary;
+
+#define CDICT_MAX_THREADS 128  // Threads that can read without locking at the same time
+
+#endif
+
+// -------------------------------
+// Function headers
+// -------------------------------
+
+/**
+ * @brief Creates a new dictionary that can be shared between threads. Writers (insert/delete) take one of
+ * stripes mutexes, chosen by hash slot, so writers on different stripes run in parallel. Readers
+ * (find) take no locks: they announce the current epoch while walking a chain, and deleted nodes are
+ * only freed once no reader that could still see them is active (epoch-based reclamation). Each stripe
+ * keeps its own list of deleted nodes and frees them in batches, so a delete takes only its stripe's lock.
+ * 
+ * @param hash_table_size The size of the hash table
+ * @param stripes The number of writer locks (clamped to 1..hash_table_size)
+ * @return ConcurrentDictionary* The newly created dictionary, or NULL on failure
+ */
+ConcurrentDictionary *concurrent_dictionary_create(int hash_table_size, int stripes);
+
+/**
+ * @brief Destroys the memory taken up by the dictionary, including its key copies. Values are not freed.
+ * No other thread may be using the dictionary.
+ * 
+ * @param CD The dictionary to destroy
+ */
+void concurrent_dictionary_destroy(ConcurrentDictionary *CD);
+
+/**
+ * @brief Inserts a copy of key with the given value. Safe to call concurrently with any other operation.
+ * 
+ * @param CD The dictionary to insert into
+ * @param key The key to insert
+ * @param value The value to store (not copied)
+ * @return true If the operation succeeded
+ * @return false If the key already exists or memory could not be allocated
+ */
+bool concurrent_dictionary_insert(ConcurrentDictionary *CD, char *key, void *value);
+
+/**
+ * @brief Removes the entry for key. Safe to call concurrently with any other operation. The entry's node
+ * and key copy are reclaimed once no reader can still reach them; the value is handed back to the
+ * caller, who must not free it while readers may still hold it.
+ * 
+ * @param CD The dictionary to remove the entry from
+ * @param key The key to remove
+ * @param value Output (may be NULL): the value of the removed entry
+ * @return true If the key was found and removed, false otherwise
+ */
+bool concurrent_dictionary_delete(ConcurrentDictionary *CD, char *key, void **value);
+
+/**
+ * @brief Looks up the value for key without taking any lock. Safe to call concurrently with any other
+ * operation; it sees either the state before or after each concurrent insert/delete.
+ * 
+ * @param CD The dictionary to search
+ * @param key The key to find
+ * @param value Output (may be NULL): the value stored for key
+ * @return true If the key was found, false otherwise
+ */
+bool concurrent_dictionary_find(ConcurrentDictionary *CD, char *key, void **value);
+
+/**
+ * @brief Gets the number of entries in the dictionary (a snapshot while writers are active)
+ * 
+ * @param CD The dictionary
+ * @return int The number of entries
+ */
+int concurrent_dictionary_size(ConcurrentDictionary *CD);
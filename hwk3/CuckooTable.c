@@ -0,0 +1,247 @@
+#include "CuckooTable.h"
+#include "HashTable.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_KICKS 128    // Entries moved looking for room before the table grows instead
+#define MAX_LOAD 0.9     // Grow once this fraction of the slots is used, before kick chains get long
+
+// One bucket: the full hashes of its entries (for filtering and for finding an entry's other bucket
+// without touching its key) and the entries themselves, 64 bytes in all.
+typedef struct CuckooBucket {
+    uint64_t hash[CUCKOO_SLOTS];
+    KVPair *pair[CUCKOO_SLOTS];
+} CuckooBucket;
+
+typedef struct CuckooTable {
+    uint32_t mask;          // Number of buckets - 1 (the bucket count is a power of two)
+    int size;               // Number of entries
+    uint32_t random;        // xorshift state for picking which entry to move
+    CuckooBucket *buckets;
+} CuckooTable;
+
+// 64-bit finalizer (splitmix64) used to spread the bits of the string hash.
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// The two candidate buckets come from the two halves of the hash. If they collide, the neighbouring
+// bucket is used so that every key still has two choices.
+static inline uint32_t first_bucket(uint64_t hash, uint32_t mask) {
+    return (uint32_t)hash & mask;
+}
+
+static inline uint32_t second_bucket(uint64_t hash, uint32_t mask) {
+    uint32_t b = (uint32_t)(hash >> 32) & mask;
+    return b != first_bucket(hash, mask) ? b : b ^ (1 & mask);
+}
+
+static inline uint32_t other_bucket(uint64_t hash, uint32_t b, uint32_t mask) {
+    return b == first_bucket(hash, mask) ? second_bucket(hash, mask) : first_bucket(hash, mask);
+}
+
+static CuckooBucket *alloc_buckets(uint32_t count) {
+    CuckooBucket *buckets = aligned_alloc(sizeof(CuckooBucket), count * sizeof(CuckooBucket));
+    if (buckets != NULL) memset(buckets, 0, count * sizeof(CuckooBucket));
+    return buckets;
+}
+
+// Puts an entry in a free slot of bucket b. Returns false if the bucket is full.
+static bool place(CuckooBucket *bucket, KVPair *pair, uint64_t hash) {
+    for (int i = 0; i < CUCKOO_SLOTS; i++) {
+        if (bucket->pair[i] == NULL) {
+            bucket->hash[i] = hash;
+            bucket->pair[i] = pair;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Inserts without growing: tries both buckets, then moves entries along a random walk until one of them
+// lands in a bucket with room. If no room turns up within MAX_KICKS moves, the moves are undone and
+// false is returned, leaving the table as it was.
+static bool insert_entry(CuckooTable *T, KVPair *pair, uint64_t hash) {
+    uint32_t b1 = first_bucket(hash, T->mask);
+    uint32_t b2 = second_bucket(hash, T->mask);
+    if (place(&T->buckets[b1], pair, hash) || place(&T->buckets[b2], pair, hash)) return true;
+    
+    uint32_t path_bucket[MAX_KICKS];
+    int path_slot[MAX_KICKS];
+    uint32_t b = b1;
+    int kicks;
+    
+    for (kicks = 0; kicks < MAX_KICKS; kicks++) {
+        // Swap the homeless entry with a random resident of bucket b, which then moves to its other bucket
+        T->random ^= T->random << 13;
+        T->random ^= T->random >> 17;
+        T->random ^= T->random << 5;
+        int slot = T->random % CUCKOO_SLOTS;
+        
+        CuckooBucket *bucket = &T->buckets[b];
+        KVPair *victim = bucket->pair[slot];
+        uint64_t victim_hash = bucket->hash[slot];
+        bucket->pair[slot] = pair;
+        bucket->hash[slot] = hash;
+        path_bucket[kicks] = b;
+        path_slot[kicks] = slot;
+        
+        pair = victim;
+        hash = victim_hash;
+        b = other_bucket(hash, b, T->mask);
+        if (place(&T->buckets[b], pair, hash)) return true;
+    }
+    
+    // Walk back, returning every moved entry to where it was
+    while (kicks-- > 0) {
+        CuckooBucket *bucket = &T->buckets[path_bucket[kicks]];
+        int slot = path_slot[kicks];
+        KVPair *moved = bucket->pair[slot];
+        uint64_t moved_hash = bucket->hash[slot];
+        bucket->pair[slot] = pair;
+        bucket->hash[slot] = hash;
+        pair = moved;
+        hash = moved_hash;
+    }
+    return false;
+}
+
+// Doubles the number of buckets (more if placement still fails) and places every entry again.
+static bool grow(CuckooTable *T) {
+    CuckooBucket *old = T->buckets;
+    uint32_t old_count = T->mask + 1;
+    
+    for (uint32_t count = old_count * 2; count != 0; count *= 2) {
+        T->buckets = alloc_buckets(count);
+        if (T->buckets == NULL) break;
+        T->mask = count - 1;
+        
+        bool ok = true;
+        for (uint32_t b = 0; b < old_count && ok; b++) {
+            for (int i = 0; i < CUCKOO_SLOTS && ok; i++) {
+                if (old[b].pair[i] != NULL) {
+                    ok = insert_entry(T, old[b].pair[i], old[b].hash[i]);
+                }
+            }
+        }
+        if (ok) {
+            free(old);
+            return true;
+        }
+        free(T->buckets);
+    }
+    
+    T->buckets = old;
+    T->mask = old_count - 1;
+    return false;
+}
+
+CuckooTable *cuckoo_create(int capacity) {
+    CuckooTable *T = malloc(sizeof(CuckooTable));
+    if (T == NULL) return NULL;
+    
+    // Smallest power of two number of buckets that holds capacity entries below MAX_LOAD
+    uint32_t count = 1;
+    while (count * CUCKOO_SLOTS * MAX_LOAD < capacity) count *= 2;
+    
+    T->mask = count - 1;
+    T->size = 0;
+    T->random = 0x9e3779b9;
+    T->buckets = alloc_buckets(count);
+    if (T->buckets == NULL) {
+        free(T);
+        return NULL;
+    }
+    return T;
+}
+
+void cuckoo_destroy(CuckooTable *T) {
+    if (T == NULL) return;
+    free(T->buckets);
+    free(T);
+}
+
+uint64_t cuckoo_hash(char *key) {
+    // FNV-1a over the key bytes, finalized with mix64
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char *c = (unsigned char *)key; *c != '\0'; c++) {
+        h ^= *c;
+        h *= 0x100000001b3ULL;
+    }
+    return mix64(h);
+}
+
+void cuckoo_prefetch(CuckooTable *T, uint64_t hash) {
+    HT_PREFETCH(&T->buckets[first_bucket(hash, T->mask)]);
+    HT_PREFETCH(&T->buckets[second_bucket(hash, T->mask)]);
+}
+
+KVPair *cuckoo_find(CuckooTable *T, char *key, uint64_t hash) {
+    CuckooBucket *bucket = &T->buckets[first_bucket(hash, T->mask)];
+    for (int probe = 0; probe < 2; probe++) {
+        for (int i = 0; i < CUCKOO_SLOTS; i++) {
+            if (bucket->pair[i] != NULL && bucket->hash[i] == hash && strcmp(bucket->pair[i]->key, key) == 0) {
+                return bucket->pair[i];
+            }
+        }
+        bucket = &T->buckets[second_bucket(hash, T->mask)];
+    }
+    return NULL;
+}
+
+bool cuckoo_insert(CuckooTable *T, KVPair *pair, uint64_t hash) {
+    if ((T->size + 1) > (T->mask + 1) * CUCKOO_SLOTS * MAX_LOAD && !grow(T)) return false;
+    
+    while (!insert_entry(T, pair, hash)) {
+        if (!grow(T)) return false;
+    }
+    T->size++;
+    return true;
+}
+
+KVPair *cuckoo_remove(CuckooTable *T, char *key, uint64_t hash) {
+    CuckooBucket *bucket = &T->buckets[first_bucket(hash, T->mask)];
+    for (int probe = 0; probe < 2; probe++) {
+        for (int i = 0; i < CUCKOO_SLOTS; i++) {
+            if (bucket->pair[i] != NULL && bucket->hash[i] == hash && strcmp(bucket->pair[i]->key, key) == 0) {
+                KVPair *removed = bucket->pair[i];
+                bucket->pair[i] = NULL;
+                T->size--;
+                return removed;
+            }
+        }
+        bucket = &T->buckets[second_bucket(hash, T->mask)];
+    }
+    return NULL;
+}
+
+KVPair *cuckoo_next(CuckooTable *T, int *pos) {
+    int slots = cuckoo_slots(T);
+    while (*pos < slots) {
+        int p = (*pos)++;
+        KVPair *pair = T->buckets[p / CUCKOO_SLOTS].pair[p % CUCKOO_SLOTS];
+        if (pair != NULL) return pair;
+    }
+    return NULL;
+}
+
+int cuckoo_slots(CuckooTable *T) {
+    return (int)(T->mask + 1) * CUCKOO_SLOTS;
+}
+
+void cuckoo_occupancy(CuckooTable *T, int *histogram) {
+    memset(histogram, 0, (CUCKOO_SLOTS + 1) * sizeof(int));
+    for (uint32_t b = 0; b <= T->mask; b++) {
+        int used = 0;
+        for (int i = 0; i < CUCKOO_SLOTS; i++) {
+            if (T->buckets[b].pair[i] != NULL) used++;
+        }
+        histogram[used]++;
+    }
+}
@@ -1,34 +1,174 @@
 #include "List.h"
 #include "HashTable.h"
 #include "Dictionary.h"
+#include "CuckooTable.h"
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define ARENA_BLOCK_SIZE 65536  // Bytes per arena block (larger requests get their own block)
+#define FIND_BATCH 16           // Keys in flight per round of dictionary_find_many
+#define DICT_LINKED (DICT_ORDERED | DICT_LRU)  // Modes that thread entries on a DictEntry list
+
+// One block of the bump allocator used in DICT_ARENA mode
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} ArenaBlock;
+
+// Entry layout in DICT_ORDERED and DICT_LRU modes: the KVPair comes first so the entry can be used as a
+// KVPair*, followed by the links of the insertion-order (or recency-order) list.
+typedef struct DictEntry {
+    KVPair pair;
+    struct DictEntry *prev;
+    struct DictEntry *next;
+} DictEntry;
+
+// Slot array of a dictionary, shared with its snapshots until the writer next modifies it.
+// bucket_refs[i], when set, points to a reference count of the chain in slot i shared by every table
+// holding that chain; NULL (or a whole NULL array) means the chain belongs to this table alone.
+typedef struct DictTable {
+    atomic_int refs;          // Dictionaries (the writer and its snapshots) using this table
+    atomic_int **bucket_refs;
+    ListPtr buckets[];
+} DictTable;
+
 typedef struct Dictionary {
     int slots;
     int size;
-    ListPtr *hash_table;
+    ListPtr *hash_table;    // table->buckets
+    DictTable *table;
+    CuckooTable *cuckoo;    // Replaces the chained table in DICT_CUCKOO mode
+    bool read_only;         // Set on snapshots
     void (*dataPrinter)(void *data);
+    int flags;
+    ArenaBlock *arena;      // Most recent arena block (DICT_ARENA mode only)
+    DictEntry *order_head;  // Oldest (DICT_ORDERED) or least recently used (DICT_LRU) entry
+    DictEntry *order_tail;  // Newest (DICT_ORDERED) or most recently used (DICT_LRU) entry
+    int capacity;                     // Maximum size before eviction, 0 for unbounded (DICT_LRU mode only)
+    void (*on_evict)(KVPair *pair);   // Called on each evicted entry (DICT_LRU mode only)
+    unsigned long hits;       // Lookups that found their key (DICT_LRU mode only)
+    unsigned long misses;     // Lookups that did not (DICT_LRU mode only)
+    unsigned long evictions;  // Entries evicted to stay within capacity (DICT_LRU mode only)
+    unsigned long lookups;      // Chain walks so far (counted in DEBUG builds)
+    unsigned long comparisons;  // Key comparisons made by those walks (counted in DEBUG builds)
 } Dictionary;
 
-// Helper function to find a node with a specific key in a list and return its index.
-// Returns -1 if the key is not found.
-static int find_key_index(ListPtr L, char *key) {
-    if (L == NULL) return -1;
+// Carves size bytes (pointer aligned) out of the dictionary's arena, starting a new block if needed.
+static void *arena_alloc(Dictionary *D, size_t size) {
+    size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    
+    ArenaBlock *block = D->arena;
+    if (block == NULL || block->capacity - block->used < size) {
+        size_t capacity = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = (ArenaBlock *)malloc(sizeof(ArenaBlock) + capacity);
+        if (block == NULL) return NULL;
+        block->used = 0;
+        block->capacity = capacity;
+        block->next = D->arena;
+        D->arena = block;
+    }
     
-    int index = 0;
-    NodePtr current = L->head;
+    void *p = block->data + block->used;
+    block->used += size;
+    return p;
+}
+
+// Allocates a KVPair holding a copy of key, either from the arena or with malloc/strdup.
+// In DICT_ORDERED and DICT_LRU modes the pair is the head of a DictEntry.
+static KVPair *new_pair(Dictionary *D, char *key) {
+    size_t pair_size = (D->flags & DICT_LINKED) ? sizeof(DictEntry) : sizeof(KVPair);
+    
+    if (D->flags & DICT_ARENA) {
+        // Pair and key bytes are carved out together in one bump allocation
+        size_t key_len = strlen(key) + 1;
+        KVPair *pair = (KVPair *)arena_alloc(D, pair_size + key_len);
+        if (pair == NULL) return NULL;
+        pair->key = (char *)pair + pair_size;
+        memcpy(pair->key, key, key_len);
+        return pair;
+    }
     
-    while (current != NULL) {
-        KVPair *pair = (KVPair *)current->data;
+    KVPair *pair = (KVPair *)malloc(pair_size);
+    if (pair == NULL) return NULL;
+    pair->key = strdup(key);
+    if (pair->key == NULL) {
+        free(pair);
+        return NULL;
+    }
+    return pair;
+}
+
+// Frees a KVPair created by new_pair. Arena pairs are released with the arena instead.
+static void free_pair(Dictionary *D, KVPair *pair) {
+    if (pair == NULL || (D->flags & DICT_ARENA)) return;
+    free(pair->key);
+    free(pair);
+}
+
+// Helper function to position a cursor on the node with a specific key in a list.
+// Returns false, with the cursor past the end, if the key is not found.
+static bool find_key_cursor(ListPtr L, char *key, ListCursor *C) {
+    for (beginList(L, C); !endList(C); nextList(C)) {
+        KVPair *pair = (KVPair *)currentList(C);
         if (pair != NULL && pair->key != NULL && strcmp(pair->key, key) == 0) {
-            return index;
+            return true;
         }
-        current = current->next;
-        index++;
     }
-    return -1;
+    return false;
+}
+
+// Links a new entry at the tail of the insertion-order list.
+static void order_append(Dictionary *D, KVPair *pair) {
+    DictEntry *entry = (DictEntry *)pair;
+    entry->prev = D->order_tail;
+    entry->next = NULL;
+    if (D->order_tail != NULL) {
+        D->order_tail->next = entry;
+    } else {
+        D->order_head = entry;
+    }
+    D->order_tail = entry;
+}
+
+// Unlinks an entry from the insertion-order list.
+static void order_remove(Dictionary *D, KVPair *pair) {
+    DictEntry *entry = (DictEntry *)pair;
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        D->order_head = entry->next;
+    }
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        D->order_tail = entry->prev;
+    }
+    entry->prev = entry->next = NULL;
+}
+
+// Helper function to find the KVPair with a specific key in a list in a single walk.
+// Returns NULL if the key is not found.
+static KVPair *find_key_pair(Dictionary *D, ListPtr L, char *key) {
+#ifdef DEBUG
+    D->lookups++;
+#else
+    (void)D;  // Only the DEBUG counters use it
+#endif
+    ListCursor cursor;
+    for (beginList(L, &cursor); !endList(&cursor); nextList(&cursor)) {
+        KVPair *pair = (KVPair *)currentList(&cursor);
+#ifdef DEBUG
+        D->comparisons++;
+#endif
+        if (pair != NULL && pair->key != NULL && strcmp(pair->key, key) == 0) {
+            return pair;
+        }
+    }
+    return NULL;
 }
 
 // Custom printer for KVPair
@@ -42,103 +182,374 @@ static void kvpair_printer(void *data) {
     }
 }
 
+// Records the outcome of a lookup in DICT_LRU mode and marks a found entry as most recently used.
+static void lru_touch(Dictionary *D, KVPair *pair) {
+    if (pair == NULL) {
+        D->misses++;
+        return;
+    }
+    D->hits++;
+    if ((DictEntry *)pair != D->order_tail) {
+        order_remove(D, pair);
+        order_append(D, pair);
+    }
+}
+
+// Evicts least recently used entries until the dictionary is within its capacity.
+static void lru_evict(Dictionary *D) {
+    while (D->capacity > 0 && D->size > D->capacity) {
+        KVPair *victim = dictionary_delete(D, D->order_head->pair.key);
+        D->evictions++;
+        
+        // The callback may free the value; the key stays valid until the entry is freed below
+        if (D->on_evict != NULL) {
+            D->on_evict(victim);
+        }
+        free_pair(D, victim);
+    }
+}
+
+// Frees a chain together with the entries it owns.
+static void free_bucket(Dictionary *D, ListPtr list) {
+    ListCursor cursor;
+    for (beginList(list, &cursor); !endList(&cursor); nextList(&cursor)) {
+        free_pair(D, (KVPair *)currentList(&cursor));
+    }
+    destroyList(&list);
+}
+
+// Copies a chain and its entries (keys are duplicated, values are shared). Returns NULL on allocation failure.
+static ListPtr copy_bucket(Dictionary *D, ListPtr list) {
+    ListPtr copy = createList(kvpair_printer);
+    if (copy == NULL) return NULL;
+    
+    ListCursor cursor;
+    for (beginList(list, &cursor); !endList(&cursor); nextList(&cursor)) {
+        KVPair *original = (KVPair *)currentList(&cursor);
+        KVPair *pair = new_pair(D, original->key);
+        if (pair == NULL || !appendList(copy, pair)) {
+            free_pair(D, pair);
+            free_bucket(D, copy);
+            return NULL;
+        }
+        pair->value = original->value;
+    }
+    return copy;
+}
+
+// Drops one reference to a table. The last reference frees the table and releases its chains,
+// freeing those no other table shares.
+static void release_table(Dictionary *D, DictTable *table) {
+    if (atomic_fetch_sub(&table->refs, 1) != 1) return;
+    
+    for (int i = 0; i < D->slots; i++) {
+        if (table->buckets[i] == NULL) continue;
+        
+        atomic_int *refs = table->bucket_refs != NULL ? table->bucket_refs[i] : NULL;
+        if (refs == NULL) {
+            free_bucket(D, table->buckets[i]);
+        } else if (atomic_fetch_sub(refs, 1) == 1) {
+            free_bucket(D, table->buckets[i]);
+            free(refs);
+        }
+    }
+    free(table->bucket_refs);
+    free(table);
+}
+
+// Gives the writer a private copy of a slot array it shares with snapshots. Only the array is copied:
+// every chain becomes shared between the old and the new table, and is copied later by make_writable
+// when the writer first touches it.
+static bool unshare_table(Dictionary *D) {
+    DictTable *old = D->table;
+    DictTable *table = (DictTable *)malloc(sizeof(DictTable) + D->slots * sizeof(ListPtr));
+    if (table == NULL) return false;
+    
+    table->bucket_refs = (atomic_int **)calloc(D->slots, sizeof(atomic_int *));
+    if (old->bucket_refs == NULL) {
+        old->bucket_refs = (atomic_int **)calloc(D->slots, sizeof(atomic_int *));
+    }
+    if (table->bucket_refs == NULL || old->bucket_refs == NULL) {
+        free(table->bucket_refs);
+        free(table);
+        return false;
+    }
+    
+    // The writer still holds its reference to the old table, so nobody else reads or frees its
+    // bucket_refs while they are filled in. A count of 1 just means "not shared yet".
+    for (int i = 0; i < D->slots; i++) {
+        if (old->buckets[i] != NULL && old->bucket_refs[i] == NULL) {
+            old->bucket_refs[i] = (atomic_int *)malloc(sizeof(atomic_int));
+            if (old->bucket_refs[i] == NULL) {
+                free(table->bucket_refs);
+                free(table);
+                return false;
+            }
+            atomic_init(old->bucket_refs[i], 1);
+        }
+    }
+    
+    atomic_init(&table->refs, 1);
+    for (int i = 0; i < D->slots; i++) {
+        table->buckets[i] = old->buckets[i];
+        table->bucket_refs[i] = old->bucket_refs[i];
+        if (table->bucket_refs[i] != NULL) {
+            atomic_fetch_add(table->bucket_refs[i], 1);
+        }
+    }
+    
+    D->table = table;
+    D->hash_table = table->buckets;
+    release_table(D, old);
+    return true;
+}
+
+// Makes slot index safe to modify in place: unshares the slot array if a snapshot still uses it, and
+// copies the slot's chain if another table still holds it. Fails on snapshots and on allocation failure.
+static bool make_writable(Dictionary *D, unsigned int index) {
+    if (D->read_only) return false;
+    if (atomic_load(&D->table->refs) > 1 && !unshare_table(D)) return false;
+    
+    DictTable *table = D->table;
+    if (table->bucket_refs == NULL || table->bucket_refs[index] == NULL) return true;
+    
+    // Only the writer adds references, so a count of 1 cannot grow behind our back
+    atomic_int *refs = table->bucket_refs[index];
+    if (atomic_load(refs) > 1) {
+        ListPtr shared = table->buckets[index];
+        ListPtr copy = copy_bucket(D, shared);
+        if (copy == NULL) return false;
+        
+        table->buckets[index] = copy;
+        // The other holders may have gone away since the check; the last one out frees the chain
+        if (atomic_fetch_sub(refs, 1) == 1) {
+            free_bucket(D, shared);
+            free(refs);
+        }
+    } else {
+        free(refs);
+    }
+    table->bucket_refs[index] = NULL;
+    return true;
+}
+
 Dictionary *dictionary_create(int hash_table_size, void (*dataPrinter)(void *data)) {
+    return dictionary_create_ex(hash_table_size, dataPrinter, 0);
+}
+
+Dictionary *dictionary_create_ex(int hash_table_size, void (*dataPrinter)(void *data), int flags) {
     Dictionary *d = (Dictionary *)malloc(sizeof(Dictionary));
     if (d == NULL) return NULL;
     
     d->slots = hash_table_size;
     d->size = 0;
     d->dataPrinter = dataPrinter;
-    
-    // Allocate array of lists
-    d->hash_table = (ListPtr *)calloc(hash_table_size, sizeof(ListPtr));
-    if (d->hash_table == NULL) {
-        free(d);
-        return NULL;
-    }
-    
-    // Initialize each list with the kvpair_printer
-    for (int i = 0; i < hash_table_size; i++) {
-        d->hash_table[i] = createList(kvpair_printer);
-        if (d->hash_table[i] == NULL) {
-            // Clean up on failure
-            for (int j = 0; j < i; j++) {
-                if (d->hash_table[j] != NULL) {
-                    destroyList(&(d->hash_table[j]));
-                }
-            }
-            free(d->hash_table);
+    d->flags = flags;
+    d->arena = NULL;
+    d->order_head = NULL;
+    d->order_tail = NULL;
+    d->capacity = 0;
+    d->on_evict = NULL;
+    d->hits = 0;
+    d->misses = 0;
+    d->evictions = 0;
+    d->lookups = 0;
+    d->comparisons = 0;
+    d->read_only = false;
+    d->table = NULL;
+    d->hash_table = NULL;
+    d->cuckoo = NULL;
+    
+    if (flags & DICT_CUCKOO) {
+        d->cuckoo = cuckoo_create(hash_table_size);
+        if (d->cuckoo == NULL) {
             free(d);
             return NULL;
         }
+        return d;
     }
     
+    // Allocate a flat array of slots, all empty. A slot's list is only created on its
+    // first insert, so empty slots cost one NULL pointer each.
+    d->table = (DictTable *)calloc(1, sizeof(DictTable) + hash_table_size * sizeof(ListPtr));
+    if (d->table == NULL) {
+        free(d);
+        return NULL;
+    }
+    atomic_init(&d->table->refs, 1);
+    d->hash_table = d->table->buckets;
+    
     return d;
 }
 
 void dictionary_destroy(Dictionary *d) {
     if (d == NULL) return;
     
-    // Free each list in the hash table
-    for (int i = 0; i < d->slots; i++) {
-        if (d->hash_table[i] != NULL) {
-            destroyList(&(d->hash_table[i]));
+    if (d->cuckoo != NULL) {
+        int pos = 0;
+        KVPair *pair;
+        while ((pair = cuckoo_next(d->cuckoo, &pos)) != NULL) {
+            free_pair(d, pair);
         }
+        cuckoo_destroy(d->cuckoo);
+    } else {
+        // Free each list in the hash table, along with the entries the dictionary owns, unless
+        // the table or some of its lists are still in use by snapshots
+        release_table(d, d->table);
+    }
+    
+    // In arena mode all entries and keys go away with the blocks
+    while (d->arena != NULL) {
+        ArenaBlock *next = d->arena->next;
+        free(d->arena);
+        d->arena = next;
     }
     
-    // Free the hash table array and dictionary
-    free(d->hash_table);
     free(d);
 }
 
-bool dictionary_insert(Dictionary *D, KVPair *elem) {
-    if (D == NULL || elem == NULL || elem->key == NULL) return false;
-    
-    // Check if key already exists
-    if (dictionary_find(D, elem->key) != NULL) {
-        return false;
-    }
+Dictionary *dictionary_snapshot(Dictionary *D) {
+    if (D == NULL || (D->flags & (DICT_ARENA | DICT_LINKED | DICT_CUCKOO))) return NULL;
+    
+    Dictionary *snapshot = (Dictionary *)malloc(sizeof(Dictionary));
+    if (snapshot == NULL) return NULL;
+    
+    // Share the slot array as is; the writer copies it on its next modification
+    *snapshot = *D;
+    snapshot->read_only = true;
+    snapshot->lookups = 0;
+    snapshot->comparisons = 0;
+    atomic_fetch_add(&D->table->refs, 1);
+    return snapshot;
+}
+
+bool dictionary_set_capacity(Dictionary *D, int capacity, void (*on_evict)(KVPair *pair)) {
+    if (D == NULL || capacity < 0 || !(D->flags & DICT_LRU) || (D->flags & DICT_ARENA)) return false;
     
-    // Calculate hash index
-    unsigned int index = ht_hash(elem->key, D->slots);
+    D->capacity = capacity;
+    D->on_evict = on_evict;
+    lru_evict(D);
+    return true;
+}
+
+KVPair *dictionary_upsert(Dictionary *D, char *key, bool *inserted) {
+    if (inserted != NULL) *inserted = false;
+    if (D == NULL || key == NULL) return NULL;
     
-    // Create a copy of the KVPair
-    KVPair *new_pair = (KVPair *)malloc(sizeof(KVPair));
-    if (new_pair == NULL) return false;
+    KVPair *pair;
+    if (D->cuckoo != NULL) {
+        // Hash once; the key can only be in its two candidate buckets
+        uint64_t hash = cuckoo_hash(key);
+        KVPair *existing = cuckoo_find(D->cuckoo, key, hash);
+        if (D->flags & DICT_LRU) {
+            lru_touch(D, existing);
+        }
+        if (existing != NULL) {
+            return existing;
+        }
+        
+        pair = new_pair(D, key);
+        if (pair == NULL) return NULL;
+        
+        pair->value = NULL;
+        if (!cuckoo_insert(D->cuckoo, pair, hash)) {
+            free_pair(D, pair);
+            return NULL;
+        }
+    } else {
+        // Hash once and walk the chain once. The chain is made private first, since the caller may
+        // update the returned entry in place.
+        unsigned int index = ht_hash(key, D->slots);
+        if (!make_writable(D, index)) return NULL;
+        ListPtr list = D->hash_table[index];
+        
+        KVPair *existing = find_key_pair(D, list, key);
+        if (D->flags & DICT_LRU) {
+            lru_touch(D, existing);
+        }
+        if (existing != NULL) {
+            return existing;
+        }
+        
+        // First entry in this slot: allocate its list now
+        if (list == NULL) {
+            list = createList(kvpair_printer);
+            if (list == NULL) return NULL;
+            D->hash_table[index] = list;
+        }
+        
+        // Key is not present: create the entry with an empty value slot
+        pair = new_pair(D, key);
+        if (pair == NULL) return NULL;
+        
+        pair->value = NULL;
+        
+        // Insert into the list at the hash index
+        if (!appendList(list, pair)) {
+            free_pair(D, pair);
+            return NULL;
+        }
+    }
     
-    new_pair->key = strdup(elem->key);
-    if (new_pair->key == NULL) {
-        free(new_pair);
-        return false;
+    if (D->flags & DICT_LINKED) {
+        order_append(D, pair);
     }
     
-    new_pair->value = elem->value;  // Just copy the pointer, don't duplicate
+    D->size++;
+    if (D->flags & DICT_LRU) {
+        lru_evict(D);
+    }
+    if (inserted != NULL) *inserted = true;
+    return pair;
+}
+
+bool dictionary_insert(Dictionary *D, KVPair *elem) {
+    if (D == NULL || elem == NULL || elem->key == NULL) return false;
     
-    // Insert into the list at the hash index
-    if (appendList(D->hash_table[index], new_pair)) {
-        D->size++;
-        return true;
+    // Fails if the key already exists (or the entry could not be allocated)
+    bool inserted;
+    KVPair *pair = dictionary_upsert(D, elem->key, &inserted);
+    if (!inserted) {
+        return false;
     }
     
-    // If append failed, clean up
-    free(new_pair->key);
-    free(new_pair);
-    return false;
+    pair->value = elem->value;  // Just copy the pointer, don't duplicate
+    return true;
 }
 
 KVPair *dictionary_delete(Dictionary *D, char *key) {
     if (D == NULL || key == NULL) return NULL;
     
-    unsigned int index = ht_hash(key, D->slots);
-    ListPtr list = D->hash_table[index];
-    
-    int key_index = find_key_index(list, key);
-    if (key_index == -1) return NULL;
-    
-    // Remove the node from the list
-    KVPair *removed = (KVPair *)deleteList(list, key_index);
+    KVPair *removed;
+    if (D->cuckoo != NULL) {
+        removed = cuckoo_remove(D->cuckoo, key, cuckoo_hash(key));
+    } else {
+        unsigned int index = ht_hash(key, D->slots);
+        ListPtr list = D->hash_table[index];
+        
+        ListCursor cursor;
+        if (!find_key_cursor(list, key, &cursor)) return NULL;
+        
+        // Work on a private copy of the chain if it is shared; the cursor then has to be placed again
+        if (!make_writable(D, index)) return NULL;
+        if (D->hash_table[index] != list) {
+            list = D->hash_table[index];
+            find_key_cursor(list, key, &cursor);
+        }
+        
+        // Unlink the node under the cursor, without walking the chain again
+        removed = (KVPair *)deleteCurrentList(&cursor);
+        
+        // Give the slot back to the empty state once its last entry is gone
+        if (lengthList(list) == 0) {
+            destroyList(&(D->hash_table[index]));
+        }
+    }
     
     if (removed != NULL) {
+        if (D->flags & DICT_LINKED) {
+            order_remove(D, removed);
+        }
         D->size--;
     }
     
@@ -148,74 +559,140 @@ KVPair *dictionary_delete(Dictionary *D, char *key) {
 KVPair *dictionary_find(Dictionary *D, char *k) {
     if (D == NULL || k == NULL) return NULL;
     
-    unsigned int index = ht_hash(k, D->slots);
-    ListPtr list = D->hash_table[index];
-    
-    int key_index = find_key_index(list, k);
-    if (key_index == -1) return NULL;
-    
-    return (KVPair *)getList(list, key_index);
+    KVPair *pair;
+    if (D->cuckoo != NULL) {
+        pair = cuckoo_find(D->cuckoo, k, cuckoo_hash(k));
+    } else {
+        unsigned int index = ht_hash(k, D->slots);
+        pair = find_key_pair(D, D->hash_table[index], k);
+    }
+    if (D->flags & DICT_LRU) {
+        lru_touch(D, pair);
+    }
+    return pair;
+}
+
+void dictionary_find_many(Dictionary *D, char **keys, int n, KVPair **results) {
+    if (results == NULL) return;
+    
+    unsigned int index[FIND_BATCH];
+    uint64_t hash[FIND_BATCH];
+    
+    for (int base = 0; base < n; base += FIND_BATCH) {
+        int count = n - base < FIND_BATCH ? n - base : FIND_BATCH;
+        
+        if (D == NULL || keys == NULL) {
+            for (int i = 0; i < count; i++) results[base + i] = NULL;
+            continue;
+        }
+        
+        if (D->cuckoo != NULL) {
+            // Both candidate buckets of every key are loaded before any is searched
+            for (int i = 0; i < count; i++) {
+                if (keys[base + i] == NULL) continue;
+                hash[i] = cuckoo_hash(keys[base + i]);
+                cuckoo_prefetch(D->cuckoo, hash[i]);
+            }
+            for (int i = 0; i < count; i++) {
+                char *key = keys[base + i];
+                results[base + i] = key == NULL ? NULL : cuckoo_find(D->cuckoo, key, hash[i]);
+                if (key != NULL && (D->flags & DICT_LRU)) {
+                    lru_touch(D, results[base + i]);
+                }
+            }
+            continue;
+        }
+        
+        // Pass 1: hash every key and start loading its slot
+        for (int i = 0; i < count; i++) {
+            if (keys[base + i] == NULL) continue;
+            index[i] = ht_hash(keys[base + i], D->slots);
+            HT_PREFETCH(&D->hash_table[index[i]]);
+        }
+        
+        // Pass 2: start loading each bucket's list header
+        for (int i = 0; i < count; i++) {
+            if (keys[base + i] == NULL) continue;
+            HT_PREFETCH(D->hash_table[index[i]]);
+        }
+        
+        // Pass 3: walk the chains, by now mostly from cache
+        for (int i = 0; i < count; i++) {
+            char *key = keys[base + i];
+            results[base + i] = key == NULL ? NULL : find_key_pair(D, D->hash_table[index[i]], key);
+            if (key != NULL && (D->flags & DICT_LRU)) {
+                lru_touch(D, results[base + i]);
+            }
+        }
+    }
 }
 
-// Helper function to compare KVPairs by key
-static int compare_kvpairs(const void *a, const void *b) {
-    const KVPair *pair_a = *(const KVPair **)a;
-    const KVPair *pair_b = *(const KVPair **)b;
+void dictionary_iter_begin(Dictionary *D, DictIter *it) {
+    if (it == NULL) return;
     
-    // Define the order based on test.out
-    const char *order[] = {"transformer", "mechanism", "model", "hhhhhh", "attention", "embedding", "layer"};
-    int index_a = -1, index_b = -1;
+    it->dict = D;
+    it->slot = 0;
+    it->pos = NULL;
+    if (D == NULL) return;
     
-    for (int i = 0; i < 7; i++) {
-        if (strcmp(pair_a->key, order[i]) == 0) index_a = i;
-        if (strcmp(pair_b->key, order[i]) == 0) index_b = i;
+    if (D->flags & DICT_LINKED) {
+        it->pos = D->order_head;
+        return;
     }
     
-    // If both keys are in our predefined order, use that order
-    if (index_a != -1 && index_b != -1) {
-        return index_a - index_b;
+    // In cuckoo mode pos is the next entry and slot the table position after it
+    if (D->cuckoo != NULL) {
+        it->pos = cuckoo_next(D->cuckoo, &it->slot);
+        return;
     }
     
-    // If only one key is in our predefined order, it comes first
-    if (index_a != -1) return -1;
-    if (index_b != -1) return 1;
-    
-    // For any other keys, use alphabetical order
-    return strcmp(pair_a->key, pair_b->key);
+    // Position on the first entry of the first non-empty slot; pos is the entry under the chain cursor
+    for (; it->slot < D->slots; it->slot++) {
+        beginList(D->hash_table[it->slot], &it->chain);
+        if (!endList(&it->chain)) {
+            it->pos = currentList(&it->chain);
+            return;
+        }
+    }
 }
 
-void dictionary_print(Dictionary *D) {
-    if (D == NULL) return;
+KVPair *dictionary_iter_next(DictIter *it) {
+    if (it == NULL || it->dict == NULL || it->pos == NULL) return NULL;
+    Dictionary *D = it->dict;
+    
+    if (D->flags & DICT_LINKED) {
+        DictEntry *entry = (DictEntry *)it->pos;
+        it->pos = entry->next;
+        return &entry->pair;
+    }
     
-    // First pass: count total entries
-    int total_entries = 0;
-    for (int i = 0; i < D->slots; i++) {
-        if (D->hash_table[i] != NULL) {
-            total_entries += lengthList(D->hash_table[i]);
-        }
+    if (D->cuckoo != NULL) {
+        KVPair *pair = (KVPair *)it->pos;
+        it->pos = cuckoo_next(D->cuckoo, &it->slot);
+        return pair;
     }
     
-    // Create array to store all entries
-    KVPair **entries = (KVPair **)malloc(total_entries * sizeof(KVPair *));
-    if (entries == NULL) return;
+    KVPair *pair = (KVPair *)it->pos;
+    nextList(&it->chain);
     
-    // Second pass: collect all entries
-    int entry_index = 0;
-    for (int i = 0; i < D->slots; i++) {
-        if (D->hash_table[i] != NULL) {
-            for (int j = 0; j < lengthList(D->hash_table[i]); j++) {
-                entries[entry_index++] = (KVPair *)getList(D->hash_table[i], j);
-            }
-        }
+    // At the end of a chain, move on to the next non-empty slot
+    while (endList(&it->chain) && ++it->slot < D->slots) {
+        beginList(D->hash_table[it->slot], &it->chain);
     }
+    it->pos = currentList(&it->chain);
+    return pair;
+}
+
+void dictionary_print(Dictionary *D) {
+    if (D == NULL) return;
     
-    // Sort entries using our custom comparison function
-    qsort(entries, total_entries, sizeof(KVPair *), compare_kvpairs);
+    // Single linear pass in iteration order; nothing is allocated or sorted
+    DictIter it;
+    dictionary_iter_begin(D, &it);
     
-    // Print entries in sorted order
-    for (int i = 0; i < total_entries; i++) {
-        KVPair *pair = entries[i];
-        if (pair != NULL && pair->key != NULL) {
+    KVPair *pair;
+    while ((pair = dictionary_iter_next(&it)) != NULL) {
+        if (pair->key != NULL) {
             printf("%s:", pair->key);
             if (pair->value != NULL) {
                 printf(" %s", (char *)pair->value);
@@ -223,6 +700,66 @@ void dictionary_print(Dictionary *D) {
             printf("\n");
         }
     }
+}
+
+void dictionary_stats(Dictionary *D, DictStats *stats) {
+    if (stats == NULL) return;
+    memset(stats, 0, sizeof(DictStats));
+    if (D == NULL) return;
+    
+    stats->size = D->size;
+    stats->slots = D->slots;
+    
+    if (D->cuckoo != NULL) {
+        // Buckets never hold more than CUCKOO_SLOTS entries, so they are reported as chains of that length
+        int occupancy[CUCKOO_SLOTS + 1];
+        cuckoo_occupancy(D->cuckoo, occupancy);
+        stats->slots = cuckoo_slots(D->cuckoo);
+        for (int length = 0; length <= CUCKOO_SLOTS; length++) {
+            if (occupancy[length] > 0) stats->max_chain = length;
+            stats->chain_histogram[length] = occupancy[length];
+        }
+    } else {
+        // Chain lengths are read from each list's length, so this costs O(slots)
+        for (int i = 0; i < D->slots; i++) {
+            int length = D->hash_table[i] != NULL ? lengthList(D->hash_table[i]) : 0;
+            if (length > stats->max_chain) stats->max_chain = length;
+            stats->chain_histogram[length < DICT_STATS_HIST - 1 ? length : DICT_STATS_HIST - 1]++;
+        }
+    }
+    stats->load_factor = stats->slots > 0 ? (double)D->size / stats->slots : 0.0;
+    
+    stats->lookups = D->lookups;
+    stats->comparisons = D->comparisons;
+    stats->comparisons_per_lookup = D->lookups > 0 ? (double)D->comparisons / D->lookups : 0.0;
+    stats->capacity = D->capacity;
+    stats->hits = D->hits;
+    stats->misses = D->misses;
+    stats->evictions = D->evictions;
+}
+
+void dictionary_stats_print(DictStats *stats) {
+    if (stats == NULL) return;
+    
+    printf("size: %d, slots: %d, load factor: %.2f, max chain: %d\n",
+           stats->size, stats->slots, stats->load_factor, stats->max_chain);
+    printf("chain length histogram:");
+    for (int i = 0; i < DICT_STATS_HIST; i++) {
+        printf(" %d%s:%d", i, i == DICT_STATS_HIST - 1 ? "+" : "", stats->chain_histogram[i]);
+    }
+    printf("\n");
+    printf("lookups: %lu, key comparisons: %lu (%.2f per lookup)\n",
+           stats->lookups, stats->comparisons, stats->comparisons_per_lookup);
+    if (stats->capacity > 0) {
+        printf("capacity: %d, hits: %lu, misses: %lu, evictions: %lu\n",
+               stats->capacity, stats->hits, stats->misses, stats->evictions);
+    }
+}
+
+void dictionary_print_stats(Dictionary *D) {
+    if (D == NULL) return;
     
-    free(entries);
-}
\ No newline at end of file
+    DictStats stats;
+    dictionary_stats(D, &stats);
+    dictionary_stats_print(&stats);
+}
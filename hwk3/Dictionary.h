@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include "List.h"
 
 #ifndef DICT_HEADER
 #define DICT_HEADER
@@ -10,6 +11,38 @@ typedef struct {
 
 typedef struct Dictionary Dictionary;
 
+// Flags for dictionary_create_ex
+#define DICT_ARENA   0x1  // Carve entries and keys from large blocks, all freed at once by dictionary_destroy
+#define DICT_ORDERED 0x2  // Iterate and print entries in insertion order
+#define DICT_LRU     0x4  // Track recency for a bounded cache (see dictionary_set_capacity)
+#define DICT_CUCKOO  0x8  // Store entries in a bucketized cuckoo table: finds probe at most two buckets
+
+// Cursor over the entries of a dictionary (see dictionary_iter_begin). Fields are private.
+typedef struct DictIter {
+    Dictionary *dict;
+    int slot;
+    void *pos;
+    ListCursor chain;   // Position in the current slot's chain in chained mode
+} DictIter;
+
+#define DICT_STATS_HIST 8  // Chain lengths 0..6 are counted individually, the last bin counts 7 and up
+
+// Health metrics of a dictionary's hash table (see dictionary_stats)
+typedef struct DictStats {
+    int size;                       // Number of entries
+    int slots;                      // Number of hash table slots
+    double load_factor;             // size / slots
+    int max_chain;                  // Length of the longest chain
+    int chain_histogram[DICT_STATS_HIST];  // Number of slots per chain length
+    unsigned long lookups;          // Chain walks by find/upsert/insert (DEBUG builds only, 0 otherwise)
+    unsigned long comparisons;      // Key comparisons made by those walks (DEBUG builds only)
+    double comparisons_per_lookup;  // comparisons / lookups
+    int capacity;                   // Capacity of a DICT_LRU dictionary, 0 if unbounded
+    unsigned long hits;             // DICT_LRU lookups that found their key
+    unsigned long misses;           // DICT_LRU lookups that did not
+    unsigned long evictions;        // Entries evicted by a DICT_LRU dictionary
+} DictStats;
+
 #endif
 
 // -------------------------------
@@ -17,7 +50,8 @@ typedef struct Dictionary Dictionary;
 // -------------------------------
 
 /**
- * @brief Creates a new dictionary.
+ * @brief Creates a new dictionary. Slots start empty and each slot's chain is only allocated on its first
+ * insert, so creating a dictionary costs a single array of hash_table_size NULL pointers.
  * 
  * @param hash_table_size The size of the hash table for the dictionary
  * @param dataPrinter Function used to print the value in the KVPair 
@@ -26,12 +60,71 @@ typedef struct Dictionary Dictionary;
 Dictionary *dictionary_create(int hash_table_size, void (*dataPrinter)(void *data));
 
 /**
- * @brief Destroys the memory taken up by the dictionary
+ * @brief Creates a new dictionary with the given mode flags.
+ * 
+ * With DICT_ARENA, each KVPair and its key copy are bump-allocated from 64KB blocks instead of malloc'd
+ * separately. Entries removed with dictionary_delete then stay owned by the dictionary (do not free them);
+ * they remain readable until dictionary_destroy releases every block in one go. This suits temporary
+ * dictionaries that are built and discarded many times.
+ * 
+ * With DICT_ORDERED, entries are also threaded on an insertion-order list, updated in O(1) by inserts and
+ * deletes, and iteration and printing follow that order instead of hash table order.
+ * 
+ * With DICT_LRU, entries are threaded on a recency list instead: every find, find_many, upsert or insert
+ * that hits an entry moves it to the most recently used end in O(1), and iteration goes from least to
+ * most recently used. Hits, misses and evictions are counted (see dictionary_stats). The dictionary
+ * stays unbounded until dictionary_set_capacity is called. DICT_LRU takes precedence over DICT_ORDERED.
+ * 
+ * With DICT_CUCKOO, entries are kept in a bucketized cuckoo hash table (four entries per bucket, two
+ * candidate buckets per key) instead of chains, so every find probes at most two buckets however unlucky
+ * the keys are. Inserts move resident entries between their buckets to make room and grow the table when
+ * that fails, so hash_table_size is only the initial capacity. Stats report bucket occupancy as chain
+ * lengths, and DEBUG lookup counters are not kept. It combines with the other flags.
+ * 
+ * @param hash_table_size The size of the hash table for the dictionary
+ * @param dataPrinter Function used to print the value in the KVPair 
+ * @param flags Bitwise OR of DICT_* flags, or 0 for the default mode
+ * @return Dictionary* The newly created dictionary
+ */
+Dictionary *dictionary_create_ex(int hash_table_size, void (*dataPrinter)(void *data), int flags);
+
+/**
+ * @brief Destroys the memory taken up by the dictionary, including the KVPairs and key copies it owns.
+ * Values are not freed.
  * 
  * @param d The dictionary to destroy
  */
 void dictionary_destroy(Dictionary *d);
 
+/**
+ * @brief Takes an O(1) read-only snapshot of the dictionary. The snapshot shares the dictionary's slot
+ * array and chains; the writer copies the array on its next insert, upsert or delete, and from then on
+ * copies each chain (with its entries) the first time it modifies it, so the snapshot keeps seeing the
+ * contents at the time it was taken. Snapshots can be read (find, find_many, iteration, printing, stats)
+ * from other threads while the writer carries on, and are released with dictionary_destroy in any order.
+ * Inserts, upserts and deletes on a snapshot fail. Entries returned by dictionary_find may be shared with
+ * snapshots, so update values through dictionary_upsert instead. DEBUG lookup counters of a snapshot are
+ * not synchronized between reader threads.
+ * 
+ * @param D The dictionary to snapshot (the writer, or another snapshot)
+ * @return Dictionary* The snapshot, or NULL on allocation failure or if D uses DICT_ARENA, DICT_ORDERED, DICT_LRU or DICT_CUCKOO
+ */
+Dictionary *dictionary_snapshot(Dictionary *D);
+
+/**
+ * @brief Bounds the size of a DICT_LRU dictionary. Whenever an insert takes the dictionary over capacity,
+ * the least recently used entry is removed and passed to on_evict, which can free its value; the entry
+ * and its key are freed by the dictionary right after the callback returns. Lowering the capacity below
+ * the current size evicts immediately.
+ * 
+ * @param D The dictionary, created with DICT_LRU and without DICT_ARENA
+ * @param capacity Maximum number of entries, or 0 for unbounded
+ * @param on_evict Function called with each evicted entry, or NULL
+ * @return true If the capacity was set
+ * @return false If D is not a DICT_LRU dictionary, uses DICT_ARENA, or capacity is negative
+ */
+bool dictionary_set_capacity(Dictionary *D, int capacity, void (*on_evict)(KVPair *pair));
+
 /**
  * @brief Insert a key-value pair into the dictionary
  * 
@@ -42,8 +135,21 @@ void dictionary_destroy(Dictionary *d);
  */
 bool dictionary_insert(Dictionary *D, KVPair *elem);
 
+/**
+ * @brief Gets the entry for the given key, inserting a new entry with a NULL value if the key is not
+ * in the dictionary. The key is hashed and its chain is walked only once.
+ * 
+ * @param D The dictionary to look up or insert into
+ * @param key The key to find or insert
+ * @param inserted Output (may be NULL): set to true if a new entry was created, false otherwise
+ * @return KVPair* The entry for the key, or NULL on allocation failure. The pointer stays valid until the
+ * entry is deleted, so its value field can be read and updated in place.
+ */
+KVPair *dictionary_upsert(Dictionary *D, char *key, bool *inserted);
+
 /**
  * @brief Removes an entry from the dictionary, returning the removed KVPair. Returns NULL if the key is not in the dictionary.
+ * The caller owns the returned KVPair and its key, except in DICT_ARENA mode (see dictionary_create_ex).
  * 
  * @param D The dictionary to remove the entry from
  * @param key The key to remove
@@ -61,8 +167,64 @@ KVPair *dictionary_delete(Dictionary *D, char *key);
 KVPair *dictionary_find(Dictionary *D, char *k);
 
 /**
- * @brief Prints the dictionary to stdout in format k1:v1 k2:v2 ... kn:vn \n
+ * @brief Looks up many independent keys at once. Keys are processed in small batches: all keys of a batch
+ * are hashed and their buckets prefetched before any chain is walked, so the cache misses of different
+ * lookups overlap instead of stalling one after another.
+ * 
+ * @param D The dictionary to search
+ * @param keys The keys to find
+ * @param n The number of keys
+ * @param results Output: results[i] is the KVPair for keys[i], or NULL if it is not in the dictionary
+ */
+void dictionary_find_many(Dictionary *D, char **keys, int n, KVPair **results);
+
+/**
+ * @brief Starts an iteration over the entries of the dictionary. Entries come in insertion order in
+ * DICT_ORDERED mode, least to most recently used in DICT_LRU mode, otherwise in hash table order (by slot,
+ * then by chain position). The dictionary must not be modified while the iteration is in progress; in
+ * DICT_LRU mode that includes lookups.
+ * 
+ * @param D The dictionary to iterate over
+ * @param it The iterator to initialize
+ */
+void dictionary_iter_begin(Dictionary *D, DictIter *it);
+
+/**
+ * @brief Advances the iterator.
+ * 
+ * @param it An iterator initialized by dictionary_iter_begin
+ * @return KVPair* The next entry, or NULL once every entry has been visited
+ */
+KVPair *dictionary_iter_next(DictIter *it);
+
+/**
+ * @brief Prints the dictionary to stdout in format k1: v1\n k2: v2\n ... kn: vn\n, in iteration order.
+ * Runs in linear time without allocating.
  * 
  * @param D The dictionary to print
  */
-void dictionary_print(Dictionary *D);
\ No newline at end of file
+void dictionary_print(Dictionary *D);
+
+/**
+ * @brief Fills in health metrics for the dictionary's hash table: size, slot count, load factor,
+ * chain-length histogram and longest chain. Lookup and key comparison counters are only maintained
+ * when the dictionary is compiled with -DDEBUG, so the lookup path carries no bookkeeping otherwise.
+ * 
+ * @param D The dictionary to inspect
+ * @param stats Output: the metrics
+ */
+void dictionary_stats(Dictionary *D, DictStats *stats);
+
+/**
+ * @brief Prints metrics filled in by dictionary_stats (or a typed dictionary's stats function) to stdout.
+ * 
+ * @param stats The metrics to print
+ */
+void dictionary_stats_print(DictStats *stats);
+
+/**
+ * @brief Prints the metrics from dictionary_stats to stdout, for debugging table sizes and hash quality.
+ * 
+ * @param D The dictionary to inspect
+ */
+void dictionary_print_stats(Dictionary *D);
\ No newline at end of file
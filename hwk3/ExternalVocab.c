@@ -0,0 +1,349 @@
+#include "ExternalVocab.h"
+#include "TypedDictionary.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_FAN_IN 64      // Runs merged at once; more runs are first merged in groups into longer runs
+#define MAX_OPEN_RUNS 128  // Runs kept before merging them down, bounding the open temporary files
+
+// A (word, first position) pair, as buffered before a run is written
+typedef struct RunRecord {
+    char *word;
+    uint64_t pos;
+} RunRecord;
+
+// Sorted runs on disk, waiting to be merged
+typedef struct RunList {
+    FILE **files;
+    int count;
+    int capacity;
+} RunList;
+
+// Reads one run during a merge
+typedef struct RunReader {
+    FILE *fp;
+    uint64_t pos;
+    char word[EXTERNAL_MAX_WORD];
+} RunReader;
+
+typedef struct ExternalVocab {
+    size_t budget;
+    uint64_t next_pos;      // Position of the next word in the stream
+    StrU64Dict *words;      // Current batch: word → first position
+    RunList word_runs;      // Batches spilled so far, each sorted by word
+    RunRecord *records;     // Deduplicated words waiting to be sorted by position
+    int record_count;
+    int record_capacity;
+    size_t record_bytes;    // Memory taken by records and their words
+    RunList pos_runs;       // Spilled records, each run sorted by position
+    bool failed;
+} ExternalVocab;
+
+// Receives the records coming out of a merge
+typedef bool (*RecordSink)(void *ctx, char *word, uint64_t pos);
+
+static int compare_by_word(const void *a, const void *b) {
+    const RunRecord *x = (const RunRecord *)a, *y = (const RunRecord *)b;
+    int c = strcmp(x->word, y->word);
+    return c != 0 ? c : (x->pos > y->pos) - (x->pos < y->pos);
+}
+
+static int compare_by_pos(const void *a, const void *b) {
+    const RunRecord *x = (const RunRecord *)a, *y = (const RunRecord *)b;
+    return (x->pos > y->pos) - (x->pos < y->pos);
+}
+
+// Record layout in a run file: position, word length, word bytes (no NUL)
+static bool write_record(FILE *fp, char *word, uint64_t pos) {
+    uint32_t len = (uint32_t)strlen(word);
+    return fwrite(&pos, sizeof(pos), 1, fp) == 1 && fwrite(&len, sizeof(len), 1, fp) == 1
+        && fwrite(word, 1, len, fp) == len;
+}
+
+static bool read_record(RunReader *r) {
+    uint32_t len;
+    if (fread(&r->pos, sizeof(r->pos), 1, r->fp) != 1 || fread(&len, sizeof(len), 1, r->fp) != 1
+        || len >= EXTERNAL_MAX_WORD || fread(r->word, 1, len, r->fp) != len) {
+        return false;
+    }
+    r->word[len] = '\0';
+    return true;
+}
+
+static bool add_run(RunList *runs, FILE *fp) {
+    if (runs->count == runs->capacity) {
+        int capacity = runs->capacity ? runs->capacity * 2 : 16;
+        FILE **files = (FILE **)realloc(runs->files, capacity * sizeof(FILE *));
+        if (files == NULL) return false;
+        runs->files = files;
+        runs->capacity = capacity;
+    }
+    runs->files[runs->count++] = fp;
+    return true;
+}
+
+static void close_runs(RunList *runs) {
+    for (int i = 0; i < runs->count; i++) {
+        fclose(runs->files[i]);
+    }
+    free(runs->files);
+    runs->files = NULL;
+    runs->count = runs->capacity = 0;
+}
+
+// Writes sorted records to a new temporary file and adds it to runs.
+static bool write_run(RunList *runs, RunRecord *records, int count) {
+    FILE *fp = tmpfile();
+    if (fp == NULL) return false;
+    
+    bool ok = true;
+    for (int i = 0; i < count && ok; i++) {
+        ok = write_record(fp, records[i].word, records[i].pos);
+    }
+    if (!ok || fflush(fp) != 0 || !add_run(runs, fp)) {
+        fclose(fp);
+        return false;
+    }
+    rewind(fp);
+    return true;
+}
+
+// Orders readers for the merge heap: by word then position, or by position only.
+static bool reader_before(RunReader *a, RunReader *b, bool by_word) {
+    if (by_word) {
+        int c = strcmp(a->word, b->word);
+        if (c != 0) return c < 0;
+    }
+    return a->pos < b->pos;
+}
+
+static void sift_down(RunReader **heap, int n, int i, bool by_word) {
+    for (;;) {
+        int least = i, left = 2 * i + 1, right = 2 * i + 2;
+        if (left < n && reader_before(heap[left], heap[least], by_word)) least = left;
+        if (right < n && reader_before(heap[right], heap[least], by_word)) least = right;
+        if (least == i) return;
+        RunReader *tmp = heap[i];
+        heap[i] = heap[least];
+        heap[least] = tmp;
+        i = least;
+    }
+}
+
+// k-way merge of runs (k <= MAX_FAN_IN) into sink, through a min-heap of readers. When merging by word,
+// repeats of a word are dropped: the first copy out of the heap carries the earliest position.
+// The run files are closed.
+static bool merge_runs(FILE **files, int k, bool by_word, RecordSink sink, void *ctx) {
+    RunReader *readers = (RunReader *)malloc(k * sizeof(RunReader));
+    RunReader **heap = (RunReader **)malloc(k * sizeof(RunReader *));
+    char *last = (char *)malloc(EXTERNAL_MAX_WORD);
+    bool ok = readers != NULL && heap != NULL && last != NULL;
+    
+    int n = 0;
+    for (int i = 0; i < k && ok; i++) {
+        readers[i].fp = files[i];
+        if (read_record(&readers[i])) heap[n++] = &readers[i];
+    }
+    for (int i = n / 2 - 1; i >= 0; i--) {
+        sift_down(heap, n, i, by_word);
+    }
+    
+    bool have_last = false;
+    while (n > 0 && ok) {
+        RunReader *top = heap[0];
+        if (!by_word || !have_last || strcmp(top->word, last) != 0) {
+            ok = sink(ctx, top->word, top->pos);
+            if (by_word) {
+                strcpy(last, top->word);
+                have_last = true;
+            }
+        }
+        if (!read_record(top)) heap[0] = heap[--n];
+        sift_down(heap, n, 0, by_word);
+    }
+    
+    for (int i = 0; i < k; i++) {
+        fclose(files[i]);
+    }
+    free(readers);
+    free(heap);
+    free(last);
+    return ok;
+}
+
+static bool sink_to_file(void *ctx, char *word, uint64_t pos) {
+    return write_record((FILE *)ctx, word, pos);
+}
+
+// Merges runs in groups of MAX_FAN_IN until at most MAX_FAN_IN remain.
+static bool reduce_runs(RunList *runs, bool by_word) {
+    while (runs->count > MAX_FAN_IN) {
+        RunList merged = {NULL, 0, 0};
+        for (int first = 0; first < runs->count; first += MAX_FAN_IN) {
+            int k = runs->count - first < MAX_FAN_IN ? runs->count - first : MAX_FAN_IN;
+            FILE *fp = tmpfile();
+            bool ok = fp != NULL && merge_runs(runs->files + first, k, by_word, sink_to_file, fp)
+                   && fflush(fp) == 0 && add_run(&merged, fp);
+            if (!ok) {
+                // The runs merged so far are closed already; close the rest
+                if (fp != NULL && (merged.count == 0 || merged.files[merged.count - 1] != fp)) fclose(fp);
+                for (int i = first + k; i < runs->count; i++) fclose(runs->files[i]);
+                runs->count = 0;
+                close_runs(&merged);
+                return false;
+            }
+            rewind(fp);
+        }
+        free(runs->files);
+        *runs = merged;
+    }
+    return true;
+}
+
+// Sorts the current batch by word and spills it as a run.
+static bool spill_words(ExternalVocab *V) {
+    uint32_t count = str_u64_dict_size(V->words);
+    RunRecord *batch = (RunRecord *)malloc((count + 1) * sizeof(RunRecord));
+    if (batch == NULL) return false;
+    
+    StrU64DictIter it;
+    StrU64DictEntry *entry;
+    uint32_t i = 0;
+    str_u64_dict_iter_begin(V->words, &it);
+    while ((entry = str_u64_dict_iter_next(&it)) != NULL) {
+        batch[i].word = str_u64_dict_key(V->words, entry);
+        batch[i].pos = entry->value;
+        i++;
+    }
+    qsort(batch, count, sizeof(RunRecord), compare_by_word);
+    
+    bool ok = write_run(&V->word_runs, batch, count)
+           && (V->word_runs.count < MAX_OPEN_RUNS || reduce_runs(&V->word_runs, true));
+    free(batch);
+    str_u64_dict_destroy(V->words);
+    V->words = ok ? str_u64_dict_create(1024) : NULL;
+    return V->words != NULL;
+}
+
+// Sorts the buffered records by position and spills them as a run.
+static bool spill_records(ExternalVocab *V) {
+    qsort(V->records, V->record_count, sizeof(RunRecord), compare_by_pos);
+    bool ok = write_run(&V->pos_runs, V->records, V->record_count)
+           && (V->pos_runs.count < MAX_OPEN_RUNS || reduce_runs(&V->pos_runs, false));
+    for (int i = 0; i < V->record_count; i++) {
+        free(V->records[i].word);
+    }
+    V->record_count = 0;
+    V->record_bytes = 0;
+    return ok;
+}
+
+// Buffers a deduplicated word for the sort by position, spilling when the budget is used up.
+static bool add_record(void *ctx, char *word, uint64_t pos) {
+    ExternalVocab *V = (ExternalVocab *)ctx;
+    size_t bytes = sizeof(RunRecord) + strlen(word) + 1;
+    if (V->record_count > 0 && V->record_bytes + bytes > V->budget && !spill_records(V)) return false;
+    
+    if (V->record_count == V->record_capacity) {
+        int capacity = V->record_capacity ? V->record_capacity * 2 : 1024;
+        RunRecord *records = (RunRecord *)realloc(V->records, capacity * sizeof(RunRecord));
+        if (records == NULL) return false;
+        V->records = records;
+        V->record_capacity = capacity;
+    }
+    V->records[V->record_count].word = strdup(word);
+    V->records[V->record_count].pos = pos;
+    if (V->records[V->record_count].word == NULL) return false;
+    V->record_count++;
+    V->record_bytes += bytes;
+    return true;
+}
+
+static bool sink_emit(void *ctx, char *word, uint64_t pos) {
+    (void)pos;
+    VocabSink *sink = (VocabSink *)ctx;
+    return sink->emit(sink->ctx, word);
+}
+
+ExternalVocab *external_vocab_create(size_t budget) {
+    ExternalVocab *V = (ExternalVocab *)calloc(1, sizeof(ExternalVocab));
+    if (V == NULL) return NULL;
+    
+    V->budget = budget;
+    V->words = str_u64_dict_create(1024);
+    if (V->words == NULL) {
+        free(V);
+        return NULL;
+    }
+    return V;
+}
+
+void external_vocab_destroy(ExternalVocab *V) {
+    if (V == NULL) return;
+    str_u64_dict_destroy(V->words);
+    close_runs(&V->word_runs);
+    for (int i = 0; i < V->record_count; i++) {
+        free(V->records[i].word);
+    }
+    free(V->records);
+    close_runs(&V->pos_runs);
+    free(V);
+}
+
+bool external_vocab_add(ExternalVocab *V, char *word) {
+    if (V == NULL || V->failed || V->words == NULL || strlen(word) >= EXTERNAL_MAX_WORD) return false;
+    
+    bool inserted;
+    uint64_t *pos = str_u64_dict_upsert(V->words, word, &inserted);
+    if (pos == NULL) {
+        V->failed = true;
+        return false;
+    }
+    if (inserted) *pos = V->next_pos;
+    V->next_pos++;
+    
+    if (str_u64_dict_memory(V->words) > V->budget && !spill_words(V)) {
+        V->failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool external_vocab_finish(ExternalVocab *V, VocabSink *sink) {
+    if (V == NULL || V->failed || V->words == NULL || sink == NULL) return false;
+    V->failed = true;  // No more words from here on
+    
+    // Phase 1: the distinct words with their first positions, deduplicated across batches
+    bool ok;
+    if (V->word_runs.count == 0) {
+        StrU64DictIter it;
+        StrU64DictEntry *entry;
+        ok = true;
+        str_u64_dict_iter_begin(V->words, &it);
+        while (ok && (entry = str_u64_dict_iter_next(&it)) != NULL) {
+            ok = add_record(V, str_u64_dict_key(V->words, entry), entry->value);
+        }
+    } else {
+        ok = spill_words(V) && reduce_runs(&V->word_runs, true)
+          && merge_runs(V->word_runs.files, V->word_runs.count, true, add_record, V);
+        V->word_runs.count = 0;  // merge_runs closed them
+    }
+    str_u64_dict_destroy(V->words);
+    V->words = NULL;
+    if (!ok) return false;
+    
+    // Phase 2: the same words in order of first position
+    if (V->pos_runs.count == 0) {
+        qsort(V->records, V->record_count, sizeof(RunRecord), compare_by_pos);
+        for (int i = 0; i < V->record_count && ok; i++) {
+            ok = sink->emit(sink->ctx, V->records[i].word);
+        }
+        return ok;
+    }
+    ok = spill_records(V) && reduce_runs(&V->pos_runs, false)
+      && merge_runs(V->pos_runs.files, V->pos_runs.count, false, sink_emit, sink);
+    V->pos_runs.count = 0;
+    return ok;
+}
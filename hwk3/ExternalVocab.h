@@ -0,0 +1,62 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef EXTERNAL_VOCAB_HEADER
+#define EXTERNAL_VOCAB_HEADER
+
+#define EXTERNAL_MAX_WORD 1024  // Longest word accepted, including the terminating NUL
+
+typedef struct ExternalVocab ExternalVocab;
+
+// Receives the distinct words from external_vocab_finish
+typedef struct VocabSink {
+    bool (*emit)(void *ctx, char *word);  // Called with each word; returns false to stop with a failure
+    void *ctx;                            // Passed to emit
+} VocabSink;
+
+#endif
+
+// -------------------------------
+// Function headers
+// -------------------------------
+
+/**
+ * @brief Creates a builder that finds the distinct words of a word stream, in first-occurrence order, using
+ * about budget bytes of memory however many distinct words there are.
+ * 
+ * Words are deduplicated in memory until the budget is used up, then the batch is sorted by word and spilled
+ * to a temporary file as a run of (word, first position) pairs. external_vocab_finish k-way merges the runs
+ * by word, keeping each word's earliest position, then sorts the result by position the same way (in memory
+ * if it fits, otherwise through a second set of runs). Temporary files are removed automatically.
+ * 
+ * @param budget Approximate number of bytes the builder may use
+ * @return ExternalVocab* The builder, or NULL on allocation failure
+ */
+ExternalVocab *external_vocab_create(size_t budget);
+
+/**
+ * @brief Destroys the builder, closing any temporary files it still holds.
+ * 
+ * @param V The builder to destroy
+ */
+void external_vocab_destroy(ExternalVocab *V);
+
+/**
+ * @brief Adds the next word of the stream.
+ * 
+ * @param V The builder
+ * @param word The word (copied)
+ * @return true If the word was added
+ * @return false On an I/O or allocation failure, or if the word is EXTERNAL_MAX_WORD bytes or longer
+ */
+bool external_vocab_add(ExternalVocab *V, char *word);
+
+/**
+ * @brief Calls sink->emit once for every distinct word, in order of first occurrence. The word passed to
+ * emit is only valid during the call. The builder accepts no more words afterwards.
+ * 
+ * @param V The builder
+ * @param sink Receives each distinct word
+ * @return true If every word was emitted, false on an I/O or allocation failure or if emit failed
+ */
+bool external_vocab_finish(ExternalVocab *V, VocabSink *sink);
@@ -0,0 +1,150 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "TypedDictionary.h"
+
+#ifndef FROZEN_DICT_HEADER
+#define FROZEN_DICT_HEADER
+
+typedef struct FrozenDictionary FrozenDictionary;
+typedef struct FrozenBuilder FrozenBuilder;
+
+#define FROZEN_MISSING UINT32_MAX  // Value reported by frozen_dictionary_find_many for absent keys
+
+#endif
+
+// -------------------------------
+// Function headers
+// -------------------------------
+
+/**
+ * @brief Compiles a string → uint32 dictionary (such as a finished vocabulary) into a read-only perfect
+ * hash table (CHD: compress, hash and displace). Every key maps to its own slot in a table with one spare
+ * slot per nine keys (load factor 0.9, which keeps the build linear in the number of keys), so a lookup is
+ * one probe and one key comparison. All keys are copied into a
+ * single packed buffer and each slot holds just a 32-bit key offset and the 32-bit value. If the values
+ * are exactly 0..size-1 (as token IDs are), a value → key index is built too (see frozen_dictionary_key).
+ * 
+ * The source dictionary is not modified and may be destroyed afterwards.
+ * 
+ * @param D The dictionary to freeze
+ * @return FrozenDictionary* The frozen dictionary, or NULL on failure
+ */
+FrozenDictionary *frozen_dictionary_create(StrU32Dict *D);
+
+/**
+ * @brief Destroys the memory taken up by the frozen dictionary
+ * 
+ * @param F The frozen dictionary to destroy
+ */
+void frozen_dictionary_destroy(FrozenDictionary *F);
+
+/**
+ * @brief Writes the frozen dictionary to a file that frozen_dictionary_open can map. The format holds
+ * offsets only, so it loads at any address. The file is written under a temporary name and renamed into
+ * place, so processes that have the old file mapped are not disturbed. Files use the native byte order.
+ * 
+ * @param F The frozen dictionary to save
+ * @param path The file to write
+ * @return true If the file was written, false on an I/O error
+ */
+bool frozen_dictionary_save(FrozenDictionary *F, const char *path);
+
+/**
+ * @brief Opens a file written by frozen_dictionary_save by mapping it read-only, in O(1): lookups read the
+ * mapped pages directly and the OS loads them on first use, sharing them through the page cache between
+ * all processes that map the same file. Only the header is validated.
+ * 
+ * @param path The file to open
+ * @return FrozenDictionary* The mapped dictionary (release it with frozen_dictionary_destroy), or NULL if the
+ * file cannot be mapped or is not a frozen dictionary file of this format version
+ */
+FrozenDictionary *frozen_dictionary_open(const char *path);
+
+/**
+ * @brief Looks up the value for the given key.
+ * 
+ * @param F The frozen dictionary to search
+ * @param key The key to find
+ * @param value Output (may be NULL): the value stored for key
+ * @return true If the key was found, false otherwise
+ */
+bool frozen_dictionary_find(FrozenDictionary *F, char *key, uint32_t *value);
+
+/**
+ * @brief Looks up many independent keys at once. Each batch of keys is hashed first, then the displacement
+ * entries, table slots and stored keys are prefetched in successive passes, so memory latency of the
+ * lookups overlaps instead of being paid one key at a time.
+ * 
+ * @param F The frozen dictionary to search
+ * @param keys The keys to find
+ * @param n The number of keys
+ * @param values Output: values[i] is the value for keys[i], or FROZEN_MISSING if it is not present
+ */
+void frozen_dictionary_find_many(FrozenDictionary *F, char **keys, int n, uint32_t *values);
+
+/**
+ * @brief Like frozen_dictionary_find_many, for keys given as byte spans that need not be NUL-terminated, so
+ * words can be looked up in place in a read-only buffer such as a mapped file.
+ * 
+ * @param F The frozen dictionary to search
+ * @param keys The start of each key
+ * @param lens lens[i] is the length of keys[i] in bytes
+ * @param n The number of keys
+ * @param values Output: values[i] is the value for keys[i], or FROZEN_MISSING if it is not present
+ */
+void frozen_dictionary_find_many_len(FrozenDictionary *F, char **keys, const uint32_t *lens, int n,
+                                     uint32_t *values);
+
+/**
+ * @brief Looks up the key stored with the given value. Only available when the values are 0..size-1.
+ * 
+ * @param F The frozen dictionary to search
+ * @param value The value to find the key for
+ * @return char* The key (owned by the dictionary), or NULL if there is none or the dictionary has no index
+ */
+char *frozen_dictionary_key(FrozenDictionary *F, uint32_t value);
+
+/**
+ * @brief Gets the number of entries in the frozen dictionary
+ * 
+ * @param F The frozen dictionary
+ * @return int The number of entries
+ */
+int frozen_dictionary_size(FrozenDictionary *F);
+
+/**
+ * @brief Creates a builder that writes a frozen dictionary file from keys added one at a time, for
+ * vocabularies too large to hold as a StrU32Dict. Keys go to a temporary file as they are added, so memory
+ * holds no key bytes: only about 30 bytes per key while the table is built (offsets, values, hashes and the
+ * table itself), which is freed once the file is written.
+ * 
+ * @return FrozenBuilder* The builder, or NULL if its temporary file cannot be created
+ */
+FrozenBuilder *frozen_builder_create(void);
+
+/**
+ * @brief Destroys the builder and removes its temporary file
+ * 
+ * @param B The builder to destroy
+ */
+void frozen_builder_destroy(FrozenBuilder *B);
+
+/**
+ * @brief Adds a key and its value. Keys must be distinct; they are not checked.
+ * 
+ * @param B The builder
+ * @param key The key (copied to the temporary file)
+ * @param value The value for key
+ * @return true If the key was added, false on an I/O error or if the keys outgrow 32-bit offsets
+ */
+bool frozen_builder_add(FrozenBuilder *B, char *key, uint32_t value);
+
+/**
+ * @brief Builds the same perfect hash table frozen_dictionary_create would build from the added keys and
+ * writes it to a file for frozen_dictionary_open, replacing it the way frozen_dictionary_save does.
+ * 
+ * @param B The builder
+ * @param path The file to write
+ * @return true If the file was written, false on an I/O or allocation failure
+ */
+bool frozen_builder_save(FrozenBuilder *B, const char *path);
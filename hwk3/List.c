@@ -3,13 +3,17 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include "List.h"
+#include "NodePool.h"
 #include <assert.h>
 
+#ifndef LIST_UNROLLED  // UnrolledList.c implements List.h instead
+
 // Constructors-Destructors
 ListPtr createList(void (*dataPrinter)(void *data)) {
 	ListPtr L = (ListPtr)malloc(sizeof(ListObj));
 	if (L) {
 		L->head = NULL;
+		L->tail = NULL;
 		L->dataPrinter = dataPrinter;
 		L->length = 0;
 	}
@@ -21,7 +25,7 @@ void destroyList(ListPtr *pL) {
 		NodePtr current = (*pL)->head;
 		while (current != NULL) {
 			NodePtr next = current->next;
-			free(current);
+			nodePoolFree(current);
 			current = next;
 		}
 		free(*pL);
@@ -59,26 +63,107 @@ void *getList(ListPtr L, int i) {
 bool appendList(ListPtr L, void *data) {
 	if (L == NULL) return false;
 	
-	NodePtr newNode = (NodePtr)malloc(sizeof(NodeObj));
+	NodePtr newNode = nodePoolAlloc();
 	if (newNode == NULL) return false;
 	
 	newNode->data = data;
 	newNode->next = NULL;
 	
+	// Link after the tail instead of walking to the end
 	if (L->head == NULL) {
 		L->head = newNode;
 	} else {
-		NodePtr current = L->head;
-		while (current->next != NULL) {
-			current = current->next;
-		}
-		current->next = newNode;
+		L->tail->next = newNode;
 	}
+	L->tail = newNode;
 	
 	L->length++;
 	return true;
 }
 
+bool extendList(ListPtr L, void **data, int n) {
+	if (L == NULL || n < 0 || (data == NULL && n > 0)) return false;
+	if (n == 0) return true;
+	
+	// Build the new nodes as a separate chain first, so a failed allocation leaves L untouched
+	NodePtr first = NULL;
+	NodePtr last = NULL;
+	for (int i = 0; i < n; i++) {
+		NodePtr newNode = nodePoolAlloc();
+		if (newNode == NULL) {
+			while (first != NULL) {
+				NodePtr next = first->next;
+				nodePoolFree(first);
+				first = next;
+			}
+			return false;
+		}
+		newNode->data = data[i];
+		newNode->next = NULL;
+		if (first == NULL) {
+			first = newNode;
+		} else {
+			last->next = newNode;
+		}
+		last = newNode;
+	}
+	
+	if (L->head == NULL) {
+		L->head = first;
+	} else {
+		L->tail->next = first;
+	}
+	L->tail = last;
+	
+	L->length += n;
+	return true;
+}
+
+// Cursor functions
+void beginList(ListPtr L, ListCursor *C) {
+	if (C == NULL) return;
+	C->list = L;
+	C->prev = NULL;
+	C->current = L ? L->head : NULL;
+}
+
+bool endList(ListCursor *C) {
+	return C == NULL || C->current == NULL;
+}
+
+void *currentList(ListCursor *C) {
+	if (C == NULL || C->current == NULL) return NULL;
+	return C->current->data;
+}
+
+void nextList(ListCursor *C) {
+	if (C == NULL || C->current == NULL) return;
+	C->prev = C->current;
+	C->current = C->current->next;
+}
+
+void *deleteCurrentList(ListCursor *C) {
+	if (C == NULL || C->current == NULL) return NULL;
+	
+	// Unlink through the remembered predecessor: no walk from the head
+	ListPtr L = C->list;
+	NodePtr removed = C->current;
+	void *data = removed->data;
+	if (C->prev == NULL) {
+		L->head = removed->next;
+	} else {
+		C->prev->next = removed->next;
+	}
+	if (L->tail == removed) {
+		L->tail = C->prev;
+	}
+	C->current = removed->next;
+	nodePoolFree(removed);
+	
+	L->length--;
+	return data;
+}
+
 void *deleteList(ListPtr L, int i) {
 	if (L == NULL || i < 0 || i >= L->length) return NULL;
 	
@@ -89,7 +174,7 @@ void *deleteList(ListPtr L, int i) {
 	if (i == 0) {
 		data = current->data;
 		L->head = current->next;
-		free(current);
+		nodePoolFree(current);
 	} else {
 		for (int j = 0; j < i; j++) {
 			prev = current;
@@ -97,9 +182,14 @@ void *deleteList(ListPtr L, int i) {
 		}
 		data = current->data;
 		prev->next = current->next;
-		free(current);
+		nodePoolFree(current);
+	}
+	if (i == L->length - 1) {
+		L->tail = prev;  // Removed the last node
 	}
 	
 	L->length--;
 	return data;
 }
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include "List.h"
+//----------------------------------------------------
+// NodePool.h
+// Header file for the NodeObj pool shared by List and Stack. In -DLIST_UNROLLED builds the pool also hands
+// out the unrolled list's chunks, from slabs of their own.
+// ---------------------------------------------------
+
+#define NODE_POOL_SLAB 256  // Nodes (or chunks) per slab
+#define NODE_POOL_LOCAL_MAX (2 * NODE_POOL_SLAB)  // Longest freelist a thread keeps to itself
+
+// Pool counters of the calling thread since the pool was last destroyed (see nodePoolStats)
+typedef struct NodePoolStats{
+    long hits;        // Allocations served from the thread's freelist (refilled from the shared list)
+    long misses;      // Allocations carved from a slab because no freed node was available
+    long frees;       // Nodes returned to the thread's freelist
+    long handedOver;  // Nodes moved from the thread's freelist to the shared list
+    long slabs;       // Slabs allocated by all threads since the pool was last destroyed, chunk slabs included
+} NodePoolStats;
+
+// Allocation functions ------------------------------
+
+/**
+ * @brief Allocates a node. Nodes come from the calling thread's freelist when it has one, then from the
+ * shared list that other threads hand surplus nodes to, otherwise from a slab of NODE_POOL_SLAB nodes
+ * that is carved up one node at a time, so malloc is called once per slab instead of once per node.
+ * 
+ * @return NodePtr The node (its fields are not initialized), or NULL if a new slab could not be allocated
+ */
+NodePtr nodePoolAlloc(void);
+
+/**
+ * @brief Returns a node to the calling thread's freelist for reuse. The memory stays with the pool
+ * until nodePoolDestroy. Once the freelist holds more than NODE_POOL_LOCAL_MAX nodes, all but
+ * NODE_POOL_SLAB of them go to the shared list, so nodes freed by one thread and allocated by another
+ * (producer/consumer) are recycled instead of piling up. When the thread exits, its freelist and the
+ * unused rest of its slab go to the shared list too.
+ * 
+ * @param node A node from nodePoolAlloc (may be NULL)
+ */
+void nodePoolFree(NodePtr node);
+
+#ifdef LIST_UNROLLED
+/**
+ * @brief Allocates a chunk of the unrolled list, the same way nodePoolAlloc allocates a node: from the
+ * calling thread's chunk freelist, then the shared chunk list, otherwise from a slab of NODE_POOL_SLAB
+ * chunks. The counters of nodePoolStats include chunks.
+ * 
+ * @return ListChunk* The chunk (its fields are not initialized), or NULL if a new slab could not be
+ * allocated
+ */
+ListChunk *chunkPoolAlloc(void);
+
+/**
+ * @brief Returns a chunk to the calling thread's chunk freelist for reuse, under the same rules as
+ * nodePoolFree.
+ * 
+ * @param chunk A chunk from chunkPoolAlloc (may be NULL)
+ */
+void chunkPoolFree(ListChunk *chunk);
+#endif
+
+// Access functions ----------------------------------
+
+/**
+ * @brief Gets the pool counters of the calling thread
+ * 
+ * @param stats Output: the counters
+ */
+void nodePoolStats(NodePoolStats *stats);
+
+// Destructor ----------------------------------------
+
+/**
+ * @brief Releases every slab of every thread and empties all freelists. No node from the pool may be in
+ * use, and no other thread may be using the pool, when this is called. The pool can be used again
+ * afterwards.
+ */
+void nodePoolDestroy(void);
+
+#endif // NODEPOOL_H
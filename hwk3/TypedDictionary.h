@@ -0,0 +1,348 @@
+#ifndef TYPED_DICT_HEADER
+#define TYPED_DICT_HEADER
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Dictionary.h"
+#include "HashTable.h"
+
+//----------------------------------------------------
+// TypedDictionary.h
+// Macro-generated dictionaries with inline key and value types
+// ---------------------------------------------------
+//
+// DEFINE_TYPED_DICTIONARY generates a chained hash table whose entries hold the key and value directly,
+// so values are never boxed behind a void* and a lookup touches no per-entry allocation. Entries live in
+// one growable array and chains link them by 32-bit index; each slot holds the index of its first entry.
+//
+// Chains keep entries in insertion order and iteration goes slot by slot, exactly like Dictionary, so a
+// string-keyed table with the same slot count lists its entries in the same order. The table doubles its
+// slot count once the average chain length exceeds TD_MAX_LOAD.
+//
+// Keys are stored as StoredKey and read back through KEY_LOAD, so a key type can keep its bytes out of
+// line: the string → uint32 table copies keys into a per-table pool and stores 32-bit offsets, making
+// each entry 12 bytes with no per-key allocation. Key helpers receive the table's TDKeyPool.
+//
+// Generated for Name/prefix (all functions are static inline):
+//   Name *prefix_create(uint32_t slots)                 Creates an empty table
+//   void prefix_destroy(Name *D)                        Frees the table and its key copies
+//   uint32_t prefix_size(Name *D)                       Number of entries
+//   KeyType prefix_key(Name *D, Name##Entry *entry)     Key of an entry (e.g. from iteration)
+//   StoredKey prefix_stored_key(Name *D, ValueType *value)
+//                                                       Stored form of the key of the entry holding value
+//   KeyType prefix_load_key(Name *D, StoredKey key)     Key back from its stored form
+//   size_t prefix_memory(Name *D)                       Bytes currently allocated by the table
+//   ValueType *prefix_find(Name *D, KeyType key)        Pointer to the value for key, or NULL
+//   ValueType *prefix_upsert(Name *D, KeyType key, bool *inserted)
+//                                                       Pointer to the value for key, inserting a zeroed
+//                                                       value first if key is absent (NULL on failure)
+//   bool prefix_insert(Name *D, KeyType key, ValueType value)   false if key exists
+//   bool prefix_delete(Name *D, KeyType key)            false if key is absent
+//   void prefix_iter_begin(Name *D, Name##Iter *it)     Starts an iteration in slot order
+//   Name##Entry *prefix_iter_next(Name##Iter *it)       Next entry, or NULL at the end
+//   void prefix_stats(Name *D, DictStats *stats)        Same metrics as dictionary_stats
+// Value pointers, and key pointers from prefix_key, stay valid until the next insertion into the table.
+// Stored keys stay valid until the key is deleted: for string keys they are pool offsets, which growth
+// does not move, so a caller can keep them (e.g. an ID → token vector) instead of copying the key.
+
+#define TD_NONE     UINT32_MAX        // End of a chain / empty slot
+#define TD_DELETED  (UINT32_MAX - 1)  // Next field of a deleted entry
+#define TD_MAX_LOAD 2                 // Average chain length that triggers doubling the slot count
+
+// Growable buffer of key bytes owned by a table; pooled keys are stored as offsets into it
+typedef struct TDKeyPool {
+    char *data;
+    uint32_t used;
+    uint32_t capacity;
+} TDKeyPool;
+
+#define DEFINE_TYPED_DICTIONARY(Name, prefix, KeyType, StoredKey, ValueType,                            \
+                                HASH, EQUAL, KEY_COPY, KEY_FREE, KEY_LOAD)                              \
+                                                                                                        \
+typedef struct Name##Entry {                                                                            \
+    StoredKey key;        /* Read it with prefix_key */                                                 \
+    ValueType value;                                                                                    \
+    uint32_t next;        /* Index of the next entry in the chain, TD_NONE or TD_DELETED */             \
+} Name##Entry;                                                                                          \
+                                                                                                        \
+typedef struct Name {                                                                                   \
+    uint32_t slots;                                                                                     \
+    uint32_t size;        /* Live entries */                                                            \
+    uint32_t used;        /* Entries handed out, including deleted ones */                              \
+    uint32_t capacity;    /* Entries allocated */                                                       \
+    uint32_t *heads;      /* First entry of each slot's chain */                                        \
+    Name##Entry *entries;                                                                               \
+    TDKeyPool pool;       /* Key bytes, for key helpers that store keys out of line */                  \
+    unsigned long lookups;      /* Counted in DEBUG builds */                                           \
+    unsigned long comparisons;  /* Counted in DEBUG builds */                                           \
+} Name;                                                                                                 \
+                                                                                                        \
+typedef struct Name##Iter {                                                                             \
+    Name *dict;                                                                                         \
+    uint32_t slot;                                                                                      \
+    uint32_t pos;                                                                                       \
+} Name##Iter;                                                                                           \
+                                                                                                        \
+static inline Name *prefix##_create(uint32_t slots) {                                                   \
+    if (slots == 0) slots = 1;                                                                          \
+    Name *D = (Name *)calloc(1, sizeof(Name));                                                          \
+    if (D == NULL) return NULL;                                                                         \
+    D->slots = slots;                                                                                   \
+    D->heads = (uint32_t *)malloc(slots * sizeof(uint32_t));                                            \
+    if (D->heads == NULL) {                                                                             \
+        free(D);                                                                                        \
+        return NULL;                                                                                    \
+    }                                                                                                   \
+    memset(D->heads, 0xff, slots * sizeof(uint32_t));                                                   \
+    return D;                                                                                           \
+}                                                                                                       \
+                                                                                                        \
+static inline void prefix##_destroy(Name *D) {                                                          \
+    if (D == NULL) return;                                                                              \
+    for (uint32_t i = 0; i < D->used; i++) {                                                            \
+        if (D->entries[i].next != TD_DELETED) {                                                         \
+            KEY_FREE(&D->pool, D->entries[i].key);                                                      \
+        }                                                                                               \
+    }                                                                                                   \
+    free(D->pool.data);                                                                                 \
+    free(D->entries);                                                                                   \
+    free(D->heads);                                                                                     \
+    free(D);                                                                                            \
+}                                                                                                       \
+                                                                                                        \
+static inline uint32_t prefix##_size(Name *D) {                                                         \
+    return D == NULL ? 0 : D->size;                                                                     \
+}                                                                                                       \
+                                                                                                        \
+static inline KeyType prefix##_key(Name *D, Name##Entry *entry) {                                       \
+    return KEY_LOAD(&D->pool, entry->key);                                                              \
+}                                                                                                       \
+                                                                                                        \
+static inline StoredKey prefix##_stored_key(Name *D, ValueType *value) {                                \
+    (void)D;                                                                                            \
+    return ((Name##Entry *)((char *)value - offsetof(Name##Entry, value)))->key;                        \
+}                                                                                                       \
+                                                                                                        \
+static inline KeyType prefix##_load_key(Name *D, StoredKey key) {                                       \
+    return KEY_LOAD(&D->pool, key);                                                                     \
+}                                                                                                       \
+                                                                                                        \
+static inline size_t prefix##_memory(Name *D) {                                                         \
+    if (D == NULL) return 0;                                                                            \
+    return sizeof(Name) + (size_t)D->slots * sizeof(uint32_t)                                           \
+         + (size_t)D->capacity * sizeof(Name##Entry) + D->pool.capacity;                                \
+}                                                                                                       \
+                                                                                                        \
+/* Walks key's chain once. Returns the matching entry index, or TD_NONE and the chain's last entry. */  \
+static inline uint32_t prefix##_probe(Name *D, KeyType key, uint32_t *slot, uint32_t *last) {           \
+    *slot = (uint32_t)(HASH(key) % D->slots);                                                           \
+    *last = TD_NONE;                                                                                    \
+    TD_COUNT(D->lookups++);                                                                             \
+    for (uint32_t i = D->heads[*slot]; i != TD_NONE; i = D->entries[i].next) {                          \
+        TD_COUNT(D->comparisons++);                                                                     \
+        if (EQUAL(KEY_LOAD(&D->pool, D->entries[i].key), key)) return i;                                \
+        *last = i;                                                                                      \
+    }                                                                                                   \
+    return TD_NONE;                                                                                     \
+}                                                                                                       \
+                                                                                                        \
+/* Rebuilds the chains over twice as many slots, dropping deleted entries. Live entries are relinked   \
+   in array order, which is insertion order, so every chain stays in insertion order. */                \
+static inline bool prefix##_grow(Name *D) {                                                             \
+    uint32_t slots = D->slots * 2;                                                                      \
+    uint32_t *heads = (uint32_t *)malloc(slots * sizeof(uint32_t));                                     \
+    uint32_t *tails = (uint32_t *)malloc(slots * sizeof(uint32_t));                                     \
+    if (heads == NULL || tails == NULL) {                                                               \
+        free(heads);                                                                                    \
+        free(tails);                                                                                    \
+        return false;                                                                                   \
+    }                                                                                                   \
+    memset(heads, 0xff, slots * sizeof(uint32_t));                                                      \
+                                                                                                        \
+    uint32_t kept = 0;                                                                                  \
+    for (uint32_t i = 0; i < D->used; i++) {                                                            \
+        if (D->entries[i].next == TD_DELETED) continue;                                                 \
+        D->entries[kept] = D->entries[i];                                                               \
+        D->entries[kept].next = TD_NONE;                                                                \
+        uint32_t s = (uint32_t)(HASH(KEY_LOAD(&D->pool, D->entries[kept].key)) % slots);                \
+        if (heads[s] == TD_NONE) {                                                                      \
+            heads[s] = kept;                                                                            \
+        } else {                                                                                        \
+            D->entries[tails[s]].next = kept;                                                           \
+        }                                                                                               \
+        tails[s] = kept;                                                                                \
+        kept++;                                                                                         \
+    }                                                                                                   \
+                                                                                                        \
+    free(tails);                                                                                        \
+    free(D->heads);                                                                                     \
+    D->heads = heads;                                                                                   \
+    D->slots = slots;                                                                                   \
+    D->used = kept;                                                                                     \
+    return true;                                                                                        \
+}                                                                                                       \
+                                                                                                        \
+static inline ValueType *prefix##_find(Name *D, KeyType key) {                                          \
+    if (D == NULL) return NULL;                                                                         \
+    uint32_t slot, last;                                                                                \
+    uint32_t i = prefix##_probe(D, key, &slot, &last);                                                  \
+    return i == TD_NONE ? NULL : &D->entries[i].value;                                                  \
+}                                                                                                       \
+                                                                                                        \
+static inline ValueType *prefix##_upsert(Name *D, KeyType key, bool *inserted) {                        \
+    if (inserted != NULL) *inserted = false;                                                            \
+    if (D == NULL) return NULL;                                                                         \
+                                                                                                        \
+    uint32_t slot, last;                                                                                \
+    uint32_t i = prefix##_probe(D, key, &slot, &last);                                                  \
+    if (i != TD_NONE) return &D->entries[i].value;                                                      \
+                                                                                                        \
+    /* Grow the table first if chains are getting long, then re-probe for the new tail */              \
+    if (D->size >= D->slots * TD_MAX_LOAD && D->slots <= UINT32_MAX / 2 && prefix##_grow(D)) {          \
+        prefix##_probe(D, key, &slot, &last);                                                           \
+    }                                                                                                   \
+    if (D->used == D->capacity) {                                                                       \
+        if (D->capacity >= TD_DELETED / 2) return NULL;                                                 \
+        uint32_t capacity = D->capacity ? D->capacity * 2 : 16;                                         \
+        Name##Entry *entries = (Name##Entry *)realloc(D->entries, capacity * sizeof(Name##Entry));      \
+        if (entries == NULL) return NULL;                                                               \
+        D->entries = entries;                                                                           \
+        D->capacity = capacity;                                                                         \
+    }                                                                                                   \
+                                                                                                        \
+    Name##Entry *entry = &D->entries[D->used];                                                          \
+    if (!KEY_COPY(&D->pool, &entry->key, key)) return NULL;                                             \
+    memset(&entry->value, 0, sizeof(ValueType));                                                        \
+    entry->next = TD_NONE;                                                                              \
+    if (last == TD_NONE) {                                                                              \
+        D->heads[slot] = D->used;                                                                       \
+    } else {                                                                                            \
+        D->entries[last].next = D->used;                                                                \
+    }                                                                                                   \
+    D->used++;                                                                                          \
+    D->size++;                                                                                          \
+    if (inserted != NULL) *inserted = true;                                                             \
+    return &entry->value;                                                                               \
+}                                                                                                       \
+                                                                                                        \
+static inline bool prefix##_insert(Name *D, KeyType key, ValueType value) {                             \
+    bool inserted;                                                                                      \
+    ValueType *slot = prefix##_upsert(D, key, &inserted);                                               \
+    if (!inserted) return false;                                                                        \
+    *slot = value;                                                                                      \
+    return true;                                                                                        \
+}                                                                                                       \
+                                                                                                        \
+static inline bool prefix##_delete(Name *D, KeyType key) {                                              \
+    if (D == NULL) return false;                                                                        \
+    uint32_t slot, prev;                                                                                \
+    uint32_t i = prefix##_probe(D, key, &slot, &prev);                                                  \
+    if (i == TD_NONE) return false;                                                                     \
+                                                                                                        \
+    if (prev == TD_NONE) {                                                                              \
+        D->heads[slot] = D->entries[i].next;                                                            \
+    } else {                                                                                            \
+        D->entries[prev].next = D->entries[i].next;                                                     \
+    }                                                                                                   \
+    KEY_FREE(&D->pool, D->entries[i].key);                                                              \
+    D->entries[i].next = TD_DELETED;                                                                    \
+    D->size--;                                                                                          \
+    return true;                                                                                        \
+}                                                                                                       \
+                                                                                                        \
+static inline void prefix##_iter_begin(Name *D, Name##Iter *it) {                                       \
+    it->dict = D;                                                                                       \
+    it->slot = 0;                                                                                       \
+    it->pos = TD_NONE;                                                                                  \
+    if (D == NULL) return;                                                                              \
+    while (it->slot < D->slots && (it->pos = D->heads[it->slot]) == TD_NONE) it->slot++;                \
+}                                                                                                       \
+                                                                                                        \
+static inline Name##Entry *prefix##_iter_next(Name##Iter *it) {                                         \
+    if (it->dict == NULL || it->pos == TD_NONE) return NULL;                                            \
+    Name *D = it->dict;                                                                                 \
+    Name##Entry *entry = &D->entries[it->pos];                                                          \
+    it->pos = entry->next;                                                                              \
+    while (it->pos == TD_NONE && ++it->slot < D->slots) it->pos = D->heads[it->slot];                   \
+    return entry;                                                                                       \
+}                                                                                                       \
+                                                                                                        \
+static inline void prefix##_stats(Name *D, DictStats *stats) {                                          \
+    memset(stats, 0, sizeof(DictStats));                                                                \
+    if (D == NULL) return;                                                                              \
+    stats->size = (int)D->size;                                                                         \
+    stats->slots = (int)D->slots;                                                                       \
+    stats->load_factor = (double)D->size / D->slots;                                                    \
+    for (uint32_t s = 0; s < D->slots; s++) {                                                           \
+        int length = 0;                                                                                 \
+        for (uint32_t i = D->heads[s]; i != TD_NONE; i = D->entries[i].next) length++;                  \
+        if (length > stats->max_chain) stats->max_chain = length;                                       \
+        stats->chain_histogram[length < DICT_STATS_HIST - 1 ? length : DICT_STATS_HIST - 1]++;          \
+    }                                                                                                   \
+    stats->lookups = D->lookups;                                                                        \
+    stats->comparisons = D->comparisons;                                                                \
+    stats->comparisons_per_lookup = D->lookups > 0 ? (double)D->comparisons / D->lookups : 0.0;         \
+}
+
+#ifdef DEBUG
+#define TD_COUNT(expr) (expr)
+#else
+#define TD_COUNT(expr) ((void)0)
+#endif
+
+// Key helpers for string keys: the table copies each key into its pool and stores the 32-bit offset.
+// Bytes of deleted keys are only given back when the table is destroyed.
+static inline unsigned long td_str_hash(char *key) { return ht_string2int(key); }
+static inline bool td_str_equal(char *a, char *b) { return strcmp(a, b) == 0; }
+static inline char *td_str_load(TDKeyPool *pool, uint32_t key) { return pool->data + key; }
+static inline void td_str_free(TDKeyPool *pool, uint32_t key) { (void)pool; (void)key; }
+static inline bool td_str_copy(TDKeyPool *pool, uint32_t *dst, char *key) {
+    size_t len = strlen(key) + 1;
+    if (len > UINT32_MAX - pool->used) return false;
+    if (pool->used + len > pool->capacity) {
+        // The key may itself live in the pool (from prefix_key), so find it again after the move
+        uintptr_t at = (uintptr_t)key - (uintptr_t)pool->data;
+        bool inside = pool->data != NULL && at < pool->used;
+        uint64_t capacity = pool->capacity ? pool->capacity : 256;
+        while (capacity < pool->used + len) capacity *= 2;
+        if (capacity > UINT32_MAX) capacity = UINT32_MAX;
+        char *data = (char *)realloc(pool->data, capacity);
+        if (data == NULL) return false;
+        if (inside) key = data + at;
+        pool->data = data;
+        pool->capacity = (uint32_t)capacity;
+    }
+    memcpy(pool->data + pool->used, key, len);
+    *dst = pool->used;
+    pool->used += len;
+    return true;
+}
+
+// Key helpers for integer keys: stored as is
+static inline unsigned long td_u64_hash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (unsigned long)key;
+}
+static inline bool td_u64_equal(uint64_t a, uint64_t b) { return a == b; }
+static inline uint64_t td_u64_load(TDKeyPool *pool, uint64_t key) { (void)pool; return key; }
+static inline bool td_u64_copy(TDKeyPool *pool, uint64_t *dst, uint64_t key) { (void)pool; *dst = key; return true; }
+static inline void td_u64_free(TDKeyPool *pool, uint64_t key) { (void)pool; (void)key; }
+
+// string → uint32 (e.g. token → ID, pair → count)
+DEFINE_TYPED_DICTIONARY(StrU32Dict, str_u32_dict, char *, uint32_t, uint32_t,
+                        td_str_hash, td_str_equal, td_str_copy, td_str_free, td_str_load)
+
+// string → uint64 (e.g. word → first corpus position)
+DEFINE_TYPED_DICTIONARY(StrU64Dict, str_u64_dict, char *, uint32_t, uint64_t,
+                        td_str_hash, td_str_equal, td_str_copy, td_str_free, td_str_load)
+
+// uint64 → uint32 (e.g. packed token pair → count in bpe.c)
+DEFINE_TYPED_DICTIONARY(U64U32Dict, u64_u32_dict, uint64_t, uint64_t, uint32_t,
+                        td_u64_hash, td_u64_equal, td_u64_copy, td_u64_free, td_u64_load)
+
+#endif
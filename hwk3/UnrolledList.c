@@ -0,0 +1,261 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "List.h"
+#include "NodePool.h"
+
+#ifdef LIST_UNROLLED  // Otherwise List.c implements List.h
+
+// Chunks that drop below this many entries absorb their successor when it fits
+#define MERGE_THRESHOLD (LIST_CHUNK / 2)
+
+static ListChunk *newChunk(void) {
+	ListChunk *chunk = chunkPoolAlloc();
+	if (chunk) {
+		chunk->next = NULL;
+		chunk->count = 0;
+	}
+	return chunk;
+}
+
+// Unlinks and frees an empty chunk, given the chunk before it (NULL at the head).
+static void removeChunk(ListPtr L, ListChunk *prev, ListChunk *chunk) {
+	if (prev == NULL) {
+		L->head = chunk->next;
+	} else {
+		prev->next = chunk->next;
+	}
+	if (L->tail == chunk) {
+		L->tail = prev;
+	}
+	chunkPoolFree(chunk);
+}
+
+// Moves the entries of the next chunk into this one when this one has become sparse and they fit,
+// so deletes cannot leave a long run of nearly empty chunks.
+static void mergeNext(ListPtr L, ListChunk *chunk) {
+	ListChunk *next = chunk->next;
+	if (chunk->count >= MERGE_THRESHOLD || next == NULL || chunk->count + next->count > LIST_CHUNK) return;
+	
+	memcpy(&chunk->data[chunk->count], next->data, next->count * sizeof(void *));
+	chunk->count += next->count;
+	next->count = 0;
+	removeChunk(L, chunk, next);
+}
+
+// Removes entry i of a chunk, closing the gap. Returns its data.
+static void *removeEntry(ListChunk *chunk, int i) {
+	void *data = chunk->data[i];
+	memmove(&chunk->data[i], &chunk->data[i + 1], (chunk->count - i - 1) * sizeof(void *));
+	chunk->count--;
+	return data;
+}
+
+// Constructors-Destructors
+ListPtr createList(void (*dataPrinter)(void *data)) {
+	ListPtr L = (ListPtr)malloc(sizeof(ListObj));
+	if (L) {
+		L->head = NULL;
+		L->tail = NULL;
+		L->dataPrinter = dataPrinter;
+		L->length = 0;
+	}
+	return L;
+}
+
+void destroyList(ListPtr *pL) {
+	if (pL && *pL) {
+		ListChunk *current = (*pL)->head;
+		while (current != NULL) {
+			ListChunk *next = current->next;
+			chunkPoolFree(current);
+			current = next;
+		}
+		free(*pL);
+		*pL = NULL;
+	}
+}
+
+// Access functions
+int lengthList(ListPtr L) {
+	if (L == NULL) return -1;
+	return L->length;
+}
+
+void printList(ListPtr L) {
+	if (L == NULL || L->dataPrinter == NULL) return;
+	
+	for (ListChunk *current = L->head; current != NULL; current = current->next) {
+		for (int i = 0; i < current->count; i++) {
+			L->dataPrinter(current->data[i]);
+		}
+	}
+}
+
+void *getList(ListPtr L, int i) {
+	if (L == NULL || i < 0 || i >= L->length) return NULL;
+	
+	// Skip whole chunks: one step per LIST_CHUNK entries
+	ListChunk *current = L->head;
+	while (i >= current->count) {
+		i -= current->count;
+		current = current->next;
+	}
+	return current->data[i];
+}
+
+// Manipulation functions
+bool appendList(ListPtr L, void *data) {
+	if (L == NULL) return false;
+	
+	// Fill the tail chunk; start a new one when it is full
+	if (L->tail == NULL || L->tail->count == LIST_CHUNK) {
+		ListChunk *chunk = newChunk();
+		if (chunk == NULL) return false;
+		
+		if (L->head == NULL) {
+			L->head = chunk;
+		} else {
+			L->tail->next = chunk;
+		}
+		L->tail = chunk;
+	}
+	
+	L->tail->data[L->tail->count++] = data;
+	L->length++;
+	return true;
+}
+
+bool extendList(ListPtr L, void **data, int n) {
+	if (L == NULL || n < 0 || (data == NULL && n > 0)) return false;
+	if (n == 0) return true;
+	
+	// Allocate every chunk needed beyond the room left in the tail first, so a failed allocation
+	// leaves L untouched
+	int room = L->tail ? LIST_CHUNK - L->tail->count : 0;
+	int needed = n > room ? (n - room + LIST_CHUNK - 1) / LIST_CHUNK : 0;
+	ListChunk *first = NULL;
+	ListChunk *last = NULL;
+	for (int c = 0; c < needed; c++) {
+		ListChunk *chunk = newChunk();
+		if (chunk == NULL) {
+			while (first != NULL) {
+				ListChunk *next = first->next;
+				chunkPoolFree(first);
+				first = next;
+			}
+			return false;
+		}
+		if (first == NULL) {
+			first = chunk;
+		} else {
+			last->next = chunk;
+		}
+		last = chunk;
+	}
+	
+	// Top up the tail, then fill the new chunks in order
+	int i = 0;
+	if (room > 0) {
+		int take = n < room ? n : room;
+		memcpy(&L->tail->data[L->tail->count], data, take * sizeof(void *));
+		L->tail->count += take;
+		i = take;
+	}
+	for (ListChunk *chunk = first; chunk != NULL; chunk = chunk->next) {
+		int take = n - i < LIST_CHUNK ? n - i : LIST_CHUNK;
+		memcpy(chunk->data, &data[i], take * sizeof(void *));
+		chunk->count = take;
+		i += take;
+	}
+	
+	if (first != NULL) {
+		if (L->head == NULL) {
+			L->head = first;
+		} else {
+			L->tail->next = first;
+		}
+		L->tail = last;
+	}
+	
+	L->length += n;
+	return true;
+}
+
+// Cursor functions
+void beginList(ListPtr L, ListCursor *C) {
+	if (C == NULL) return;
+	C->list = L;
+	C->prev = NULL;
+	C->current = L ? L->head : NULL;
+	C->index = 0;
+}
+
+bool endList(ListCursor *C) {
+	return C == NULL || C->current == NULL;
+}
+
+void *currentList(ListCursor *C) {
+	if (C == NULL || C->current == NULL) return NULL;
+	return C->current->data[C->index];
+}
+
+void nextList(ListCursor *C) {
+	if (C == NULL || C->current == NULL) return;
+	if (++C->index == C->current->count) {
+		C->prev = C->current;
+		C->current = C->current->next;
+		C->index = 0;
+	}
+}
+
+void *deleteCurrentList(ListCursor *C) {
+	if (C == NULL || C->current == NULL) return NULL;
+	
+	ListPtr L = C->list;
+	ListChunk *chunk = C->current;
+	void *data = removeEntry(chunk, C->index);
+	L->length--;
+	
+	if (chunk->count == 0) {
+		// The chunk emptied: drop it and continue at the start of the next one
+		C->current = chunk->next;
+		C->index = 0;
+		removeChunk(L, C->prev, chunk);
+		return data;
+	}
+	
+	// Merging only appends after the entries of this chunk, so the cursor index stays valid
+	mergeNext(L, chunk);
+	if (C->index == chunk->count) {
+		C->prev = chunk;
+		C->current = chunk->next;
+		C->index = 0;
+	}
+	return data;
+}
+
+void *deleteList(ListPtr L, int i) {
+	if (L == NULL || i < 0 || i >= L->length) return NULL;
+	
+	ListChunk *prev = NULL;
+	ListChunk *current = L->head;
+	while (i >= current->count) {
+		i -= current->count;
+		prev = current;
+		current = current->next;
+	}
+	
+	void *data = removeEntry(current, i);
+	if (current->count == 0) {
+		removeChunk(L, prev, current);
+	} else {
+		mergeNext(L, current);
+	}
+	
+	L->length--;
+	return data;
+}
+
+#endif
@@ -0,0 +1,320 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "Dictionary.h"
+#include "TypedDictionary.h"
+#include "FrozenDictionary.h"
+#include "ConcurrentDictionary.h"
+
+//----------------------------------------------------
+// bench.c
+// Timing benchmarks for the dictionaries. Build with optimization:
+//   make bench CFLAGS="-O2"
+//   ./bench find_many [keys]
+//   ./bench concurrent [keys]
+//   ./bench cuckoo [keys]
+// ---------------------------------------------------
+
+#define LOOKUPS 4000000  // Lookups timed per measurement
+#define BATCH 256        // Keys per find_many call, about one line of text in tokenize_line
+#define WORD_SIZE 24     // Bytes per generated word, NUL included
+#define MAX_BENCH_THREADS 32     // Largest thread count of the concurrent benchmark
+#define OPS_PER_THREAD 500000    // Operations per thread in the concurrent benchmark
+#define WRITE_PERCENT 10         // Share of those operations that insert or delete
+#define TAIL_LOOKUPS 1000000     // Lookups timed one by one in the cuckoo benchmark
+
+// Seconds on a monotonic clock
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Deterministic pseudo-random numbers (xorshift64), so runs are comparable
+uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Make n distinct words in one buffer; words[i] points to the i-th
+char **make_words(int n) {
+    char **words = malloc(n * sizeof(char *));
+    char *buffer = malloc((size_t)n * WORD_SIZE);
+    if (!words || !buffer) {
+        perror("make_words");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        words[i] = buffer + (size_t)i * WORD_SIZE;
+        sprintf(words[i], "w%x_%d", (unsigned)(i * 2654435761u), i);
+    }
+    return words;
+}
+
+void free_words(char **words) {
+    free(words[0]);
+    free(words);
+}
+
+// Queries: LOOKUPS random picks among the n words, so most lookups miss the cache once n is large
+char **make_queries(char **words, int n) {
+    char **queries = malloc(LOOKUPS * sizeof(char *));
+    if (!queries) {
+        perror("make_queries");
+        exit(1);
+    }
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < LOOKUPS; i++) {
+        queries[i] = words[next_random(&state) % n];
+    }
+    return queries;
+}
+
+// find vs find_many, on Dictionary and on FrozenDictionary, for vocabularies in and out of cache
+void bench_find_many(int n) {
+    char **words = make_words(n);
+    char **queries = make_queries(words, n);
+    KVPair **pairs = malloc(BATCH * sizeof(KVPair *));
+    uint32_t ids[BATCH];
+    long found = 0;
+
+    Dictionary *D = dictionary_create(n, NULL);
+    StrU32Dict *typed = str_u32_dict_create(n);
+    for (int i = 0; i < n; i++) {
+        dictionary_upsert(D, words[i], NULL)->value = words[i];
+        str_u32_dict_insert(typed, words[i], i);
+    }
+    FrozenDictionary *F = frozen_dictionary_create(typed);
+    if (!F) {
+        printf("Failed to freeze the vocabulary\n");
+        exit(1);
+    }
+
+    double start = now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        found += dictionary_find(D, queries[i]) != NULL;
+    }
+    double find = now() - start;
+
+    start = now();
+    for (int i = 0; i < LOOKUPS; i += BATCH) {
+        dictionary_find_many(D, queries + i, LOOKUPS - i < BATCH ? LOOKUPS - i : BATCH, pairs);
+        found += pairs[0] != NULL;
+    }
+    double find_many = now() - start;
+
+    start = now();
+    for (int i = 0; i < LOOKUPS; i++) {
+        found += frozen_dictionary_find(F, queries[i], NULL);
+    }
+    double frozen_find = now() - start;
+
+    start = now();
+    for (int i = 0; i < LOOKUPS; i += BATCH) {
+        frozen_dictionary_find_many(F, queries + i, LOOKUPS - i < BATCH ? LOOKUPS - i : BATCH, ids);
+        found += ids[0] != FROZEN_MISSING;
+    }
+    double frozen_find_many = now() - start;
+
+    printf("%d keys, %d lookups (checksum %ld)\n", n, LOOKUPS, found);
+    printf("  Dictionary:        find %6.1f ns  find_many %6.1f ns  (%.2fx)\n", find * 1e9 / LOOKUPS,
+           find_many * 1e9 / LOOKUPS, find / find_many);
+    printf("  FrozenDictionary:  find %6.1f ns  find_many %6.1f ns  (%.2fx)\n", frozen_find * 1e9 / LOOKUPS,
+           frozen_find_many * 1e9 / LOOKUPS, frozen_find / frozen_find_many);
+
+    frozen_dictionary_destroy(F);
+    str_u32_dict_destroy(typed);
+    dictionary_destroy(D);
+    free(pairs);
+    free(queries);
+    free_words(words);
+}
+
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Times every lookup on its own and prints the latency percentiles; half of the queries miss
+void time_lookups(const char *name, Dictionary *D, char **queries, double *latency) {
+    long found = 0;
+    for (int i = 0; i < TAIL_LOOKUPS; i++) {
+        double start = now();
+        found += dictionary_find(D, queries[i]) != NULL;
+        latency[i] = now() - start;
+    }
+    qsort(latency, TAIL_LOOKUPS, sizeof(double), compare_doubles);
+    printf("  %-10s %8.0f %8.0f %8.0f %8.0f   (%ld found)\n", name, latency[TAIL_LOOKUPS / 2] * 1e9,
+           latency[TAIL_LOOKUPS / 100 * 99] * 1e9, latency[TAIL_LOOKUPS / 1000 * 999] * 1e9,
+           latency[TAIL_LOOKUPS - 1] * 1e9, found);
+}
+
+// Lookup latency of a chained Dictionary against a DICT_CUCKOO one holding the same n keys. Chains get
+// long on unlucky slots, while a cuckoo lookup probes two buckets at most, which shows in the tail.
+void bench_cuckoo(int n) {
+    char **words = make_words(2 * n);  // Only the first n are inserted; the rest are misses
+    char **queries = make_queries(words, 2 * n);
+    double *latency = malloc(TAIL_LOOKUPS * sizeof(double));
+    if (!latency) {
+        perror("bench_cuckoo");
+        exit(1);
+    }
+
+    Dictionary *chained = dictionary_create(n, NULL);
+    Dictionary *cuckoo = dictionary_create_ex(n, NULL, DICT_CUCKOO);
+    for (int i = 0; i < n; i++) {
+        dictionary_upsert(chained, words[i], NULL);
+        dictionary_upsert(cuckoo, words[i], NULL);
+    }
+
+    printf("%d keys, %d lookups, latency in ns (includes about one clock read)\n", n, TAIL_LOOKUPS);
+    printf("  %-10s %8s %8s %8s %8s\n", "", "p50", "p99", "p99.9", "max");
+    time_lookups("chained", chained, queries, latency);
+    time_lookups("cuckoo", cuckoo, queries, latency);
+
+    dictionary_destroy(chained);
+    dictionary_destroy(cuckoo);
+    free(latency);
+    free(queries);
+    free_words(words);
+}
+
+// One thread of the concurrent benchmark: mostly finds of shared words, plus inserts and deletes of words
+// private to the thread, against either a ConcurrentDictionary or a Dictionary behind one mutex
+typedef struct MixedWorker {
+    ConcurrentDictionary *concurrent;  // NULL to use dict and lock instead
+    Dictionary *dict;
+    pthread_mutex_t *lock;
+    char **words;
+    int n;
+    int id;
+    long found;
+} MixedWorker;
+
+void *run_mixed(void *arg) {
+    MixedWorker *w = arg;
+    uint64_t state = 0x9e3779b97f4a7c15ULL * (w->id + 1);
+    char key[WORD_SIZE];
+    int churn = 0;  // Private words inserted so far; odd steps delete the last one again
+
+    for (int op = 0; op < OPS_PER_THREAD; op++) {
+        uint64_t r = next_random(&state);
+        if (r % 100 >= WRITE_PERCENT) {
+            char *word = w->words[(r >> 8) % w->n];
+            if (w->concurrent) {
+                w->found += concurrent_dictionary_find(w->concurrent, word, NULL);
+            } else {
+                pthread_mutex_lock(w->lock);
+                w->found += dictionary_find(w->dict, word) != NULL;
+                pthread_mutex_unlock(w->lock);
+            }
+            continue;
+        }
+
+        bool insert = churn % 2 == 0;
+        sprintf(key, "t%d_%d", w->id, churn / 2);
+        churn++;
+        if (w->concurrent) {
+            if (insert) {
+                concurrent_dictionary_insert(w->concurrent, key, NULL);
+            } else {
+                concurrent_dictionary_delete(w->concurrent, key, NULL);
+            }
+        } else {
+            pthread_mutex_lock(w->lock);
+            if (insert) {
+                dictionary_upsert(w->dict, key, NULL);
+            } else {
+                KVPair *pair = dictionary_delete(w->dict, key);
+                if (pair) {
+                    free(pair->key);
+                    free(pair);
+                }
+            }
+            pthread_mutex_unlock(w->lock);
+        }
+    }
+    return NULL;
+}
+
+// Runs the mixed workload on the given number of threads; returns millions of operations per second
+double time_mixed(ConcurrentDictionary *concurrent, Dictionary *dict, char **words, int n, int threads) {
+    pthread_t workers[MAX_BENCH_THREADS];
+    MixedWorker args[MAX_BENCH_THREADS];
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+    double start = now();
+    for (int t = 0; t < threads; t++) {
+        args[t] = (MixedWorker){concurrent, dict, &lock, words, n, t, 0};
+        if (pthread_create(&workers[t], NULL, run_mixed, &args[t]) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t], NULL);
+    }
+    return (double)threads * OPS_PER_THREAD / (now() - start) / 1e6;
+}
+
+// ConcurrentDictionary (striped writer locks, lock-free reads) against a Dictionary behind one mutex, with
+// 1 to MAX_BENCH_THREADS threads running a read-mostly workload
+void bench_concurrent(int n) {
+    char **words = make_words(n);
+    ConcurrentDictionary *concurrent = concurrent_dictionary_create(n, 64);
+    Dictionary *dict = dictionary_create(n, NULL);
+    for (int i = 0; i < n; i++) {
+        concurrent_dictionary_insert(concurrent, words[i], NULL);
+        dictionary_upsert(dict, words[i], NULL);
+    }
+
+    printf("%d keys, %d operations per thread, %d%% inserts/deletes (Mops/s)\n", n, OPS_PER_THREAD,
+           WRITE_PERCENT);
+    printf("  threads  ConcurrentDictionary  Dictionary+mutex\n");
+    for (int threads = 1; threads <= MAX_BENCH_THREADS; threads *= 2) {
+        double lock_free = time_mixed(concurrent, NULL, words, n, threads);
+        double locked = time_mixed(NULL, dict, words, n, threads);
+        printf("  %7d  %20.2f  %16.2f\n", threads, lock_free, locked);
+    }
+
+    concurrent_dictionary_destroy(concurrent);
+    dictionary_destroy(dict);
+    free_words(words);
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 2 ? atoi(argv[2]) : 0;
+
+    if (argc > 1 && strcmp(argv[1], "find_many") == 0) {
+        if (n > 0) {
+            bench_find_many(n);
+        } else {
+            bench_find_many(10000);     // Fits in cache
+            bench_find_many(2000000);   // Far larger than cache
+        }
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "concurrent") == 0) {
+        bench_concurrent(n > 0 ? n : 100000);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "cuckoo") == 0) {
+        if (n > 0) {
+            bench_cuckoo(n);
+        } else {
+            bench_cuckoo(10000);
+            bench_cuckoo(1000000);
+        }
+        return 0;
+    }
+
+    printf("Usage: %s find_many|concurrent|cuckoo [keys]\n", argv[0]);
+    return 1;
+}
@@ -1,127 +1,756 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "Dictionary.h"
+#include "TypedDictionary.h"
+#include "FrozenDictionary.h"
+#include "ExternalVocab.h"
+#include "NodePool.h"
 
 #define MAX_LINE_LEN 1024    // Maximum length of a line read from file or stdin
 #define MAX_TOKEN_LEN 64     // Maximum length of a token (word)
-#define INIT_VOCAB_SIZE 256  // Initial vocabulary size (not actively used here)
+#define INIT_VOCAB_SIZE 256  // Initial capacity of the id_to_token vector
+#define MAX_THREADS 64       // Maximum number of build threads (-j)
+#define TOKENIZE_BATCH 256   // Words looked up per frozen_dictionary_find_many_len call in tokenize_file
+#define OUTPUT_BUFFER_SIZE (1 << 20)  // Bytes of IDs gathered per write in tokenize_file
+#define DEMO_TOKENS 16       // Vocabulary entries copied into the insert/delete demo dictionary
 
-// Global dictionaries:
-// - token_to_id: maps token (string) → token ID (string)
-// - id_to_token: maps token ID (string) → token (string)
-Dictionary *token_to_id;
-Dictionary *id_to_token;
+// Global vocabulary:
+// - token_to_id: maps token (string) → token ID (stored inline as uint32)
+// - id_to_token: dense vector indexed by token ID → the token's offset in token_to_id's key pool (read it
+//   with str_u32_dict_load_key); IDs are handed out sequentially and tokens are not copied again
+StrU32Dict *token_to_id;
+uint32_t *id_to_token;
+int id_to_token_capacity = 0;
+FrozenDictionary *vocab;  // Read-only copy of token_to_id used for tokenizing
 int next_token_id = 0;  // Counter to assign unique token IDs
 
 // Function to print a key-value pair, used by dictionary_print
 void print_KVPair(void *data) {
-    printf("%s: %s\n", ((KVPair *)data)->key, (char*)((KVPair *)data)->value);
+    printf("%s: %s\n", ((KVPair *)data)->key, (char *)((KVPair *)data)->value);
+}
+
+// Print the vocabulary as "token: id" lines, walking id_to_token in ID order like print_frozen_vocabulary,
+// so a corpus run and a run on the saved vocabulary print the same
+void print_vocabulary(void) {
+    for (int id = 0; id < next_token_id; id++) {
+        printf("%s: %d\n", str_u32_dict_load_key(token_to_id, id_to_token[id]), id);
+    }
+}
+
+// Print a mapped vocabulary as "token: id" lines, in ID order
+void print_frozen_vocabulary(FrozenDictionary *vocabulary) {
+    for (int id = 0; id < frozen_dictionary_size(vocabulary); id++) {
+        char *token = frozen_dictionary_key(vocabulary, id);
+        if (token != NULL) {
+            printf("%s: %d\n", token, id);
+        }
+    }
 }
 
 // Add a new token (word) to the vocabulary if it doesn’t already exist
 void add_token(char *token) {
-    // Check if the token is already in the dictionary
-    if (dictionary_find(token_to_id, token) != NULL)
+    // Look up the token and create its entry in a single probe
+    bool inserted;
+    uint32_t *id = str_u32_dict_upsert(token_to_id, token, &inserted);
+    if (!id) {
+        perror("Failed to add a token");
+        exit(1);
+    }
+    if (!inserted)
         return;  // Token already exists, skip
 
-    // Convert the next_token_id (integer) to a string
-    char *id_str = malloc(16);
-    sprintf(id_str, "%d", next_token_id);
+    // Fill in token_to_id: token → ID (no string or allocation needed)
+    *id = next_token_id;
 
-    // Insert into token_to_id: token → ID
-    char *token_copy = strdup(token);
-    KVPair *fwd = malloc(sizeof(KVPair));
-    fwd->key = strdup(token_copy);
-    fwd->value = strdup(id_str);
-    dictionary_insert(token_to_id, fwd);
-
-    // Insert into id_to_token: ID → token
-    KVPair *rev = malloc(sizeof(KVPair));
-    rev->key = strdup(id_str);
-    rev->value = token_copy;  // Reuse the copy here
-    dictionary_insert(id_to_token, rev);
+    // Append to id_to_token: the new ID is the next index, doubling the vector when it is full. It keeps the
+    // offset of the key token_to_id just copied, so each token is stored once.
+    if (next_token_id == id_to_token_capacity) {
+        int capacity = id_to_token_capacity ? id_to_token_capacity * 2 : INIT_VOCAB_SIZE;
+        uint32_t *grown = realloc(id_to_token, capacity * sizeof(uint32_t));
+        if (!grown) {
+            perror("Failed to grow id_to_token");
+            exit(1);
+        }
+        id_to_token = grown;
+        id_to_token_capacity = capacity;
+    }
+    id_to_token[next_token_id] = str_u32_dict_stored_key(token_to_id, id);
 
     next_token_id++;  // Increment the unique ID counter
 }
 
+// Finds the piece of a line that one fgets(line, MAX_LINE_LEN, fp) call returns when reading from pos: up
+// to and including the next newline, but at most MAX_LINE_LEN - 1 bytes. *text_end is set to where
+// strtok stops in that piece, at its first NUL byte if it has one. Returns the end of the piece, where the
+// next fgets call starts.
+const char *next_line_piece(const char *pos, const char *end, const char **text_end) {
+    const char *piece_end = end - pos > MAX_LINE_LEN - 1 ? pos + MAX_LINE_LEN - 1 : end;
+    const char *newline = memchr(pos, '\n', piece_end - pos);
+    if (newline) piece_end = newline + 1;
+    const char *nul = memchr(pos, '\0', piece_end - pos);
+    *text_end = nul ? nul : piece_end;
+    return piece_end;
+}
+
+// One worker's share of the corpus in a parallel build
+typedef struct CorpusShard {
+    const char *start;   // First byte, always at the start of a line
+    const char *end;     // One past the last byte
+    StrU32Dict *words;   // Word → rank of its first occurrence in the shard
+    char **order;        // Words by rank, filled in once the shard is complete
+    bool failed;         // Out of memory
+} CorpusShard;
+
+// Intern the words of one shard. Lines are cut exactly like the serial fgets/strtok loop does (see
+// next_line_piece).
+void *build_shard(void *arg) {
+    CorpusShard *shard = (CorpusShard *)arg;
+    char word[MAX_LINE_LEN];
+    const char *pos = shard->start;
+
+    while (pos < shard->end) {
+        const char *text_end;
+        const char *piece_end = next_line_piece(pos, shard->end, &text_end);
+
+        // Split it on spaces and newlines, like strtok(line, " \n")
+        const char *p = pos;
+        while (p < text_end) {
+            while (p < text_end && (*p == ' ' || *p == '\n')) p++;
+            const char *w = p;
+            while (p < text_end && *p != ' ' && *p != '\n') p++;
+            if (p == w) break;
+
+            memcpy(word, w, p - w);
+            word[p - w] = '\0';
+            bool inserted;
+            uint32_t *rank = str_u32_dict_upsert(shard->words, word, &inserted);
+            if (!rank) {
+                shard->failed = true;
+                return NULL;
+            }
+            if (inserted) *rank = str_u32_dict_size(shard->words) - 1;
+        }
+        pos = piece_end;
+    }
+
+    // Line the words up by rank; their keys stay put now that the shard takes no more inserts
+    shard->order = malloc((str_u32_dict_size(shard->words) + 1) * sizeof(char *));
+    if (!shard->order) {
+        shard->failed = true;
+        return NULL;
+    }
+    StrU32DictIter it;
+    StrU32DictEntry *entry;
+    str_u32_dict_iter_begin(shard->words, &it);
+    while ((entry = str_u32_dict_iter_next(&it)) != NULL) {
+        shard->order[entry->value] = str_u32_dict_key(shard->words, entry);
+    }
+    return NULL;
+}
+
+// Build the vocabulary with several threads: the mapped corpus is cut at line starts into one shard per
+// thread, each thread interns its shard's words, and the shards are merged in corpus order. A word's first
+// occurrence is in the first shard that has it, at its rank there, so IDs come out exactly as in the serial
+// loop. Returns false, having read nothing, if the corpus cannot be mapped (e.g. it is a pipe).
+bool read_corpus_parallel(FILE *fp, int threads) {
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    size_t size = st.st_size;
+    if (size == 0) return true;
+
+    char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (data == MAP_FAILED) return false;
+
+    CorpusShard shards[MAX_THREADS];
+    pthread_t workers[MAX_THREADS];
+    bool started[MAX_THREADS];
+    const char *start = data;
+    for (int t = 0; t < threads; t++) {
+        // End each shard just past the first newline at or after its even share
+        const char *end = data + size;
+        if (t < threads - 1) {
+            const char *target = data + size / threads * (t + 1);
+            if (target < start) target = start;
+            const char *newline = memchr(target, '\n', data + size - target);
+            if (newline) end = newline + 1;
+        }
+
+        shards[t].start = start;
+        shards[t].end = end;
+        shards[t].words = str_u32_dict_create(101);
+        shards[t].order = NULL;
+        shards[t].failed = shards[t].words == NULL;
+        started[t] = !shards[t].failed && pthread_create(&workers[t], NULL, build_shard, &shards[t]) == 0;
+        if (!started[t] && !shards[t].failed) {
+            build_shard(&shards[t]);  // No thread to spare: build this shard here
+        }
+        start = end;
+    }
+
+    bool failed = false;
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(workers[t], NULL);
+        }
+        failed = failed || shards[t].failed;
+    }
+    if (failed) {
+        printf("Out of memory while building the vocabulary\n");
+        exit(1);
+    }
+
+    // Merge in corpus order: add_token skips words an earlier shard already added
+    for (int t = 0; t < threads; t++) {
+        for (uint32_t rank = 0; rank < str_u32_dict_size(shards[t].words); rank++) {
+            add_token(shards[t].order[rank]);
+        }
+        free(shards[t].order);
+        str_u32_dict_destroy(shards[t].words);
+    }
+
+    munmap(data, size);
+    return true;
+}
+
+// Numbers the distinct words coming out of the external build and streams them into the vocabulary file
+typedef struct VocabStream {
+    FrozenBuilder *builder;
+    uint32_t next_id;
+} VocabStream;
+
+bool stream_token(void *ctx, char *word) {
+    VocabStream *stream = ctx;
+    return frozen_builder_add(stream->builder, word, stream->next_id++);
+}
+
+// Build the vocabulary within a memory budget and write it straight to a vocabulary file: the distinct
+// words are found with sorted runs spilled to temporary files, and the final pass (in first-occurrence
+// order, so IDs match the serial build) streams them into a FrozenBuilder, which keeps no words in memory.
+// token_to_id and id_to_token are never built. Returns false on an I/O or allocation failure.
+bool read_corpus_external(FILE *fp, size_t budget, const char *path) {
+    ExternalVocab *words = external_vocab_create(budget);
+    VocabStream stream = {frozen_builder_create(), 0};
+    VocabSink sink = {stream_token, &stream};
+    bool ok = words != NULL && stream.builder != NULL;
+
+    char line[MAX_LINE_LEN];
+    while (ok && fgets(line, sizeof(line), fp)) {
+        char *word = strtok(line, " \n");
+        while (ok && word) {
+            ok = external_vocab_add(words, word);
+            word = strtok(NULL, " \n");
+        }
+    }
+    ok = ok && external_vocab_finish(words, &sink);
+    external_vocab_destroy(words);
+    ok = ok && frozen_builder_save(stream.builder, path);
+    frozen_builder_destroy(stream.builder);
+    return ok;
+}
+
+// How much of the corpus a pruned (-k) vocabulary covers
+typedef struct CoverageStats {
+    uint32_t distinct;       // Distinct words in the corpus
+    uint32_t kept;           // Words given an ID
+    uint64_t tokens;         // Words in the corpus
+    uint64_t covered;        // Words in the corpus that have an ID; the rest map to UNK
+} CoverageStats;
+
+// True if word a should lose its place in the top K before word b: fewer occurrences, or as many but
+// seen later in the corpus
+bool ranks_worse(const uint32_t *count, uint32_t a, uint32_t b) {
+    if (count[a] != count[b]) return count[a] < count[b];
+    return a > b;
+}
+
+// Sift a heap of ranks down from i, keeping the worst word at the root
+void sift_worst_down(const uint32_t *count, uint32_t *heap, uint32_t n, uint32_t i) {
+    for (;;) {
+        uint32_t worst = i, left = 2 * i + 1, right = 2 * i + 2;
+        if (left < n && ranks_worse(count, heap[left], heap[worst])) worst = left;
+        if (right < n && ranks_worse(count, heap[right], heap[worst])) worst = right;
+        if (worst == i) return;
+        uint32_t tmp = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = tmp;
+        i = worst;
+    }
+}
+
+// Build a vocabulary of only the k most frequent words: one pass counts every word exactly, then a heap of
+// k words keeps the most frequent as the counts are scanned, in O(n log k). IDs go by descending count,
+// ties by first occurrence, so the most common words get the smallest IDs; pruned words tokenize as UNK.
+// Returns false on an allocation failure.
+bool read_corpus_top_k(FILE *fp, uint32_t k, CoverageStats *coverage) {
+    StrU32Dict *ranks = str_u32_dict_create(1024);  // Word → rank of its first occurrence
+    uint32_t *count = NULL;                         // Occurrences by rank
+    uint32_t capacity = 0;
+    memset(coverage, 0, sizeof(CoverageStats));
+    if (!ranks) return false;
+
+    char line[MAX_LINE_LEN];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        char *word = strtok(line, " \n");
+        while (ok && word) {
+            bool inserted;
+            uint32_t *rank = str_u32_dict_upsert(ranks, word, &inserted);
+            if (rank && inserted) {
+                *rank = str_u32_dict_size(ranks) - 1;
+                if (*rank == capacity) {
+                    capacity = capacity ? capacity * 2 : INIT_VOCAB_SIZE;
+                    uint32_t *grown = realloc(count, capacity * sizeof(uint32_t));
+                    if (grown) count = grown;
+                    ok = grown != NULL;
+                }
+                if (ok) count[*rank] = 0;
+            }
+            ok = ok && rank != NULL;
+            if (ok) count[*rank]++;
+            coverage->tokens++;
+            word = strtok(NULL, " \n");
+        }
+    }
+
+    // Keep the k best ranks, with the worst of them at the root, ready to be replaced
+    uint32_t distinct = str_u32_dict_size(ranks);
+    uint32_t kept = distinct < k ? distinct : k;
+    uint32_t *heap = ok ? malloc((kept + 1) * sizeof(uint32_t)) : NULL;
+    char **order = ok ? malloc((distinct + 1) * sizeof(char *)) : NULL;
+    ok = heap != NULL && order != NULL;
+    if (ok) {
+        for (uint32_t rank = 0; rank < kept; rank++) {
+            heap[rank] = rank;
+        }
+        for (uint32_t i = kept / 2; i-- > 0;) {
+            sift_worst_down(count, heap, kept, i);
+        }
+        for (uint32_t rank = kept; rank < distinct; rank++) {
+            if (ranks_worse(count, heap[0], rank)) {
+                heap[0] = rank;
+                sift_worst_down(count, heap, kept, 0);
+            }
+        }
+
+        StrU32DictIter it;
+        StrU32DictEntry *entry;
+        str_u32_dict_iter_begin(ranks, &it);
+        while ((entry = str_u32_dict_iter_next(&it)) != NULL) {
+            order[entry->value] = str_u32_dict_key(ranks, entry);
+        }
+
+        // Pop the worst word each time and fill the IDs from the back, so the best word ends up with ID 0
+        uint32_t *by_id = malloc((kept + 1) * sizeof(uint32_t));
+        ok = by_id != NULL;
+        for (uint32_t n = kept; ok && n > 0; n--) {
+            by_id[n - 1] = heap[0];
+            heap[0] = heap[n - 1];
+            sift_worst_down(count, heap, n - 1, 0);
+        }
+        for (uint32_t id = 0; ok && id < kept; id++) {
+            add_token(order[by_id[id]]);
+            coverage->covered += count[by_id[id]];
+        }
+        free(by_id);
+        coverage->distinct = distinct;
+        coverage->kept = kept;
+    }
+
+    free(heap);
+    free(order);
+    free(count);
+    str_u32_dict_destroy(ranks);
+    return ok;
+}
+
+// Print how much of the corpus the pruned vocabulary covers
+void print_coverage(CoverageStats *coverage) {
+    printf("Top-K coverage:\n");
+    printf("  words kept: %u of %u distinct (%.2f%%)\n", coverage->kept, coverage->distinct,
+           coverage->distinct ? 100.0 * coverage->kept / coverage->distinct : 0.0);
+    printf("  tokens covered: %llu of %llu (%.2f%%)\n", (unsigned long long)coverage->covered,
+           (unsigned long long)coverage->tokens,
+           coverage->tokens ? 100.0 * coverage->covered / coverage->tokens : 0.0);
+    printf("  tokens mapped to UNK: %llu\n", (unsigned long long)(coverage->tokens - coverage->covered));
+}
+
+// Look up the token for an ID: from id_to_token after a corpus build, or from the mapped vocabulary
+char *token_for_id(uint32_t id) {
+    if (id_to_token != NULL) {
+        return id < (uint32_t)next_token_id ? str_u32_dict_load_key(token_to_id, id_to_token[id]) : NULL;
+    }
+    return frozen_dictionary_key(vocab, id);
+}
+
 // Given a line of text, print out the token IDs for each known word
 void tokenize_line(char *line) {
+    // Split the whole line first so all lookups can be issued as one batch
+    char *tokens[MAX_LINE_LEN / 2 + 1];
+    uint32_t ids[MAX_LINE_LEN / 2 + 1];
+    int count = 0;
+
     char *token = strtok(line, " \n");
     while (token) {
-        KVPair *kv = dictionary_find(token_to_id, token);
-        if (kv) {
-            printf("%s ", (char *)kv->value);  // Print token’s ID
+        tokens[count++] = token;
+        token = strtok(NULL, " \n");
+    }
+
+    frozen_dictionary_find_many(vocab, tokens, count, ids);
+
+    for (int i = 0; i < count; i++) {
+        if (ids[i] != FROZEN_MISSING) {
+            printf("%u ", ids[i]);  // Print token’s ID
         } else {
             printf("UNK ");  // If unknown, print "UNK"
         }
-        token = strtok(NULL, " \n");
     }
     printf("\n");
 }
 
-int main(int argc, char **argv) {
-    // Check that a corpus file is provided
-    if (argc < 2) {
-        printf("Usage: %s <corpus_file>\n", argv[0]);
-        return 1;
-    }
-
-    // Open the corpus file
-    FILE *fp = fopen(argv[1], "r");
-    if (!fp) {
-        perror("Failed to open file");
-        return 1;
+// Given a line of token IDs, print out the token for each one
+void decode_line(char *line) {
+    char *field = strtok(line, " \n");
+    while (field) {
+        char *end;
+        unsigned long id = strtoul(field, &end, 10);
+        char *token = (*end == '\0' && id <= UINT32_MAX) ? token_for_id((uint32_t)id) : NULL;
+        printf("%s ", token ? token : "UNK");  // Unknown or malformed IDs print "UNK"
+        field = strtok(NULL, " \n");
     }
+    printf("\n");
+}
 
-    // Create two dictionaries with 101 hash slots
-    token_to_id = dictionary_create(101, print_KVPair);
-    id_to_token = dictionary_create(101, print_KVPair);
+// Output buffer for tokenize_file: IDs are formatted straight into it and it goes out in large writes
+typedef struct OutputBuffer {
+    FILE *fp;
+    size_t used;
+    bool failed;             // A write failed
+    char data[OUTPUT_BUFFER_SIZE];
+} OutputBuffer;
 
-    char line[MAX_LINE_LEN];
+void output_flush(OutputBuffer *out) {
+    if (out->used > 0 && fwrite(out->data, 1, out->used, out->fp) != out->used) out->failed = true;
+    out->used = 0;
+}
 
-    // Read the corpus line by line and build the vocabulary
-    while (fgets(line, sizeof(line), fp)) {
-        char *word = strtok(line, " \n");
-        while (word) {
-            add_token(word);  // Add each word to the vocabulary
-            word = strtok(NULL, " \n");
+// Append the IDs of a batch of words: "id " (or "UNK ") per word as text, or one native-endian uint32 per
+// word in binary, with FROZEN_MISSING standing for UNK
+void output_ids(OutputBuffer *out, uint32_t *ids, int count, bool binary) {
+    for (int i = 0; i < count; i++) {
+        if (OUTPUT_BUFFER_SIZE - out->used < 16) output_flush(out);
+        char *dst = out->data + out->used;
+        if (binary) {
+            memcpy(dst, &ids[i], sizeof(uint32_t));
+            out->used += sizeof(uint32_t);
+        } else if (ids[i] == FROZEN_MISSING) {
+            memcpy(dst, "UNK ", 4);
+            out->used += 4;
+        } else {
+            // Digits come out backwards; write them to the end of a scratch area, then move them up
+            char digits[10];
+            int n = 0;
+            uint32_t id = ids[i];
+            do {
+                digits[sizeof(digits) - ++n] = '0' + id % 10;
+                id /= 10;
+            } while (id > 0);
+            memcpy(dst, digits + sizeof(digits) - n, n);
+            dst[n] = ' ';
+            out->used += n + 1;
         }
     }
+}
+
+// Tokenize a whole file without copying it: the file is mapped, words are looked up in place as byte spans,
+// and IDs go out through an OutputBuffer. The file is cut into lines and words exactly as the stdin loop
+// cuts it for tokenize_line (see next_line_piece): a line longer than MAX_LINE_LEN - 1 bytes is split, so
+// is a word that straddles the split, and the rest of a line after a NUL byte is skipped. Text output has
+// a line of IDs per line tokenize_line would be given; binary output is one flat stream of uint32 IDs.
+// Returns false if the input cannot be mapped or the output cannot be written.
+bool tokenize_file(const char *path, FILE *output, bool binary) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return false;
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode)) {
+        fclose(fp);
+        return false;
+    }
+    size_t size = st.st_size;
+    char *data = size ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(fp), 0) : NULL;
+    fclose(fp);  // The mapping stays valid
+    if (data == MAP_FAILED) return false;
+    if (size) madvise(data, size, MADV_SEQUENTIAL);
 
-    fclose(fp);  // Close the corpus file
+    OutputBuffer *out = malloc(sizeof(OutputBuffer));
+    if (!out) {
+        if (size) munmap(data, size);
+        return false;
+    }
+    out->fp = output;
+    out->used = 0;
+    out->failed = false;
 
-    // Print out the final vocabulary: token → ID
-    printf("Vocabulary:\n");
-    dictionary_print(token_to_id);
+    char *words[TOKENIZE_BATCH];
+    uint32_t lens[TOKENIZE_BATCH];
+    uint32_t ids[TOKENIZE_BATCH];
+    int count = 0;
+    const char *end = data + size;
+    const char *p = data;
 
-    // Prompt the user for input to tokenize
-    printf("\nEnter sentence to tokenize (or Ctrl+D to exit):\n");
-    while (fgets(line, sizeof(line), stdin)) {
-        tokenize_line(line);  // Tokenize and print ID sequence
+    while (p < end && !out->failed) {
+        const char *text_end;
+        const char *piece_end = next_line_piece(p, end, &text_end);
+
+        // Split the piece on spaces and newlines, like strtok(line, " \n"), looking words up a batch at a time
+        while (p < text_end) {
+            if (*p == ' ' || *p == '\n') {
+                p++;
+                continue;
+            }
+            const char *w = p;
+            while (p < text_end && *p != ' ' && *p != '\n') p++;
+            words[count] = (char *)w;
+            lens[count] = (uint32_t)(p - w);  // At most MAX_LINE_LEN - 1
+            if (++count == TOKENIZE_BATCH) {
+                frozen_dictionary_find_many_len(vocab, words, lens, count, ids);
+                output_ids(out, ids, count, binary);
+                count = 0;
+            }
+        }
+        frozen_dictionary_find_many_len(vocab, words, lens, count, ids);
+        output_ids(out, ids, count, binary);
+        count = 0;
+        if (!binary) {
+            if (out->used == OUTPUT_BUFFER_SIZE) output_flush(out);
+            out->data[out->used++] = '\n';
+        }
+        p = piece_end;
     }
 
+    output_flush(out);
+    bool ok = !out->failed && fflush(output) == 0;
+    free(out);
+    if (size) munmap(data, size);
+    return ok;
+}
+
+// The insert/delete tests printed after the interactive input. They edit a small Dictionary of their own,
+// holding the first DEMO_TOKENS tokens in ID order, so the vocabulary (mapped or not) is left as it is.
+void demo_insert_delete(void) {
     printf("\n---------------------------------\n");
 
+    char id_strings[DEMO_TOKENS][16];
+    Dictionary *demo = dictionary_create_ex(101, print_KVPair, DICT_ORDERED);
+    if (!demo) {
+        printf("Failed to create the test dictionary\n");
+        return;
+    }
+    for (uint32_t id = 0; id < DEMO_TOKENS; id++) {
+        char *token = token_for_id(id);
+        if (token == NULL) break;
+        KVPair *pair = dictionary_upsert(demo, token, NULL);
+        if (pair) {
+            sprintf(id_strings[id], "%u", id);
+            pair->value = id_strings[id];
+        }
+    }
+
     // --- Testing section for dictionary_insert ---
-    char *temp_token = strdup("hhhhhh");
-    KVPair *kvp = malloc(sizeof(KVPair));
-    kvp->key = strdup(temp_token);
-    kvp->value = strdup("666");
-    dictionary_insert(token_to_id, kvp);
+    KVPair kvp = {"hhhhhh", "666"};  // dictionary_insert copies the key and keeps the value pointer
+    dictionary_insert(demo, &kvp);
     printf("Test dictionary_insert:\n");
-    dictionary_print(token_to_id);
+    dictionary_print(demo);
 
     printf("\n---------------------------------\n");
 
     // --- Testing section for dictionary_delete ---
-    dictionary_delete(token_to_id, "hhhhhh");
+    KVPair *removed = dictionary_delete(demo, "hhhhhh");
+    if (removed) {
+        free(removed->key);
+        free(removed);
+    }
     printf("Test dictionary_delete:\n");
-    dictionary_print(token_to_id);
+    dictionary_print(demo);
+    dictionary_destroy(demo);
+}
+
+int main(int argc, char **argv) {
+    char *vocab_in = NULL;   // -i: map a vocabulary saved earlier instead of reading a corpus
+    char *vocab_out = NULL;  // -o: save the vocabulary built from the corpus
+    bool decode = false;     // -d: turn ID sequences back into tokens instead of tokenizing
+    int threads = 1;         // -j: number of threads building the vocabulary
+    long budget_mb = 0;      // -m: build the vocabulary out of core within this many megabytes, into -o
+    long top_k = 0;          // -k: keep only the top_k most frequent words
+    char *input_file = NULL; // -t: tokenize this file in place instead of reading sentences from stdin
+    char *binary_out = NULL; // -B: write the IDs of the -t file to this file as uint32s instead of text
+    bool bad_args = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "dB:i:j:k:m:o:t:")) != -1) {
+        switch (opt) {
+            case 'd': decode = true; break;
+            case 'j':
+                threads = atoi(optarg);
+                if (threads < 1 || threads > MAX_THREADS) bad_args = true;
+                break;
+            case 'k':
+                top_k = atol(optarg);
+                if (top_k < 1 || top_k > UINT32_MAX) bad_args = true;
+                break;
+            case 'm':
+                budget_mb = atol(optarg);
+                if (budget_mb < 1) bad_args = true;
+                break;
+            case 'i': vocab_in = optarg; break;
+            case 'o': vocab_out = optarg; break;
+            case 't': input_file = optarg; break;
+            case 'B': binary_out = optarg; break;
+            default: bad_args = true; break;
+        }
+    }
+
+    // Check that a corpus file (or a saved vocabulary) is provided; -j, -k and -m pick different builds
+    // -t replaces the stdin loop, so it excludes -d; -B only applies to -t; -m writes its vocabulary to -o
+    int builds = (threads > 1) + (top_k > 0) + (budget_mb > 0);
+    bool bad_input = (input_file != NULL && decode) || (binary_out != NULL && input_file == NULL)
+                  || (budget_mb > 0 && (vocab_out == NULL || vocab_in != NULL));
+    if (bad_args || builds > 1 || bad_input || (vocab_in == NULL && optind >= argc)) {
+        printf("Usage: %s [-d | -t input_file [-B ids_file]] [-j threads | -k top_k] [-o vocab_file]\n",
+               argv[0]);
+        printf("       %*s <corpus_file>\n", (int)strlen(argv[0]), "");
+        printf("       %s [-d | -t input_file [-B ids_file]] -m megabytes -o vocab_file <corpus_file>\n",
+               argv[0]);
+        printf("       %s [-d | -t input_file [-B ids_file]] -i vocab_file\n", argv[0]);
+        return 1;
+    }
+
+    char line[MAX_LINE_LEN];
+
+    if (budget_mb > 0) {
+        // Build the vocabulary out of core straight into the -o file, then map it like -i
+        FILE *fp = fopen(argv[optind], "r");
+        if (!fp) {
+            perror("Failed to open file");
+            return 1;
+        }
+        bool ok = read_corpus_external(fp, (size_t)budget_mb << 20, vocab_out);
+        fclose(fp);
+        if (!ok) {
+            printf("Failed to build vocabulary out of core\n");
+            return 1;
+        }
+        vocab_in = vocab_out;
+    }
+
+    if (vocab_in != NULL) {
+        // Map the saved vocabulary: no corpus pass, and its pages are shared with other processes
+        vocab = frozen_dictionary_open(vocab_in);
+        if (!vocab) {
+            printf("Failed to open vocabulary: %s\n", vocab_in);
+            return 1;
+        }
+
+        printf("Vocabulary:\n");
+        print_frozen_vocabulary(vocab);
+    } else {
+        // Open the corpus file
+        FILE *fp = fopen(argv[optind], "r");
+        if (!fp) {
+            perror("Failed to open file");
+            return 1;
+        }
+
+        // Create the token → ID dictionary with 101 hash slots
+        token_to_id = str_u32_dict_create(101);
+
+        // Read the corpus line by line and build the vocabulary (in parallel with -j when possible)
+        CoverageStats coverage;
+        if (top_k > 0) {
+            if (!read_corpus_top_k(fp, (uint32_t)top_k, &coverage)) {
+                printf("Out of memory while building the vocabulary\n");
+                fclose(fp);
+                return 1;
+            }
+        } else if (threads == 1 || !read_corpus_parallel(fp, threads)) {
+            while (fgets(line, sizeof(line), fp)) {
+                char *word = strtok(line, " \n");
+                while (word) {
+                    add_token(word);  // Add each word to the vocabulary
+                    word = strtok(NULL, " \n");
+                }
+            }
+        }
+
+        fclose(fp);  // Close the corpus file
+
+        // The vocabulary is complete: freeze it for single-probe lookups while tokenizing
+        vocab = frozen_dictionary_create(token_to_id);
+        if (!vocab) {
+            printf("Failed to freeze the vocabulary\n");
+            return 1;
+        }
+        if (vocab_out != NULL && !frozen_dictionary_save(vocab, vocab_out)) {
+            printf("Failed to save vocabulary: %s\n", vocab_out);
+        }
+
+        // Print out the final vocabulary: token → ID
+        printf("Vocabulary:\n");
+        print_vocabulary();
+        if (top_k > 0) {
+            print_coverage(&coverage);
+        }
+
+        // Dump hash table health (build with -DDEBUG)
+        #ifdef DEBUG
+        DictStats stats;
+        str_u32_dict_stats(token_to_id, &stats);
+        printf("\ntoken_to_id stats:\n");
+        dictionary_stats_print(&stats);
+        #endif
+    }
+
+    if (input_file != NULL) {
+        // Tokenize the whole input file in one mapped pass, as text on stdout or as binary IDs
+        FILE *output = stdout;
+        if (binary_out != NULL) {
+            output = fopen(binary_out, "wb");
+        } else {
+            printf("\nTokenized %s:\n", input_file);
+        }
+        bool ok = output != NULL && tokenize_file(input_file, output, binary_out != NULL);
+        if (output != NULL && output != stdout && fclose(output) != 0) ok = false;
+        if (!ok) {
+            printf("Failed to tokenize %s\n", input_file);
+            return 1;
+        }
+    } else if (decode) {
+        // Prompt the user for token IDs to turn back into text
+        printf("\nEnter token IDs to decode (or Ctrl+D to exit):\n");
+        while (fgets(line, sizeof(line), stdin)) {
+            decode_line(line);  // Print the token for each ID
+        }
+    } else {
+        // Prompt the user for input to tokenize
+        printf("\nEnter sentence to tokenize (or Ctrl+D to exit):\n");
+        while (fgets(line, sizeof(line), stdin)) {
+            tokenize_line(line);  // Tokenize and print ID sequence
+        }
+    }
+
+    if (input_file == NULL) {
+        demo_insert_delete();  // Part of the interactive runs' output (test.out), not of -t's
+    }
 
     // Clean up all allocated memory
-    dictionary_destroy(token_to_id);
-    dictionary_destroy(id_to_token);
+    frozen_dictionary_destroy(vocab);
+    str_u32_dict_destroy(token_to_id);
+    free(id_to_token);
+    nodePoolDestroy();  // Every list is gone: release the node slabs
 
     return 0;
 }
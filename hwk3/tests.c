@@ -0,0 +1,366 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "Dictionary.h"
+#include "TypedDictionary.h"
+#include "ConcurrentDictionary.h"
+#include "NodePool.h"
+
+//----------------------------------------------------
+// tests.c
+// Self-tests for the dictionaries, kept out of the tokenizer:
+//   make test
+// Prints one line per test and exits with status 1 if any of them failed.
+// ---------------------------------------------------
+
+#define STRESS_WRITERS 4      // Writer threads in the ConcurrentDictionary test
+#define STRESS_READERS 4      // Reader threads in the ConcurrentDictionary test
+#define STRESS_KEYS 20000     // Keys per writer in the ConcurrentDictionary test
+#define CUCKOO_TEST_KEYS 3000 // Keys in the DICT_CUCKOO test, enough to grow a one-slot table many times
+
+int failed_tests = 0;  // Dictionary tests that failed (see report_test)
+
+// Print the outcome of one dictionary test
+void report_test(const char *name, bool ok) {
+    printf("Test %s: %s\n", name, ok ? "correct" : "INCORRECT");
+    if (!ok) failed_tests++;
+}
+
+// Free an entry removed with dictionary_delete
+void free_pair(KVPair *pair) {
+    if (pair) {
+        free(pair->key);
+        free(pair);
+    }
+}
+
+// str_u32_dict_insert/delete, the typed API the vocabulary is built on: an insert refuses a key that is
+// already there, a delete refuses a missing key, and the remaining keys keep their values
+void test_typed_dictionary(void) {
+    StrU32Dict *D = str_u32_dict_create(7);  // Few slots, so chains are long
+    char key[16];
+    bool ok = D != NULL;
+    for (uint32_t i = 0; ok && i < 50; i++) {
+        sprintf(key, "key%u", i);
+        ok = str_u32_dict_insert(D, key, i) && !str_u32_dict_insert(D, key, i + 100);
+    }
+    for (uint32_t i = 0; ok && i < 50; i += 3) {
+        sprintf(key, "key%u", i);
+        ok = str_u32_dict_delete(D, key) && !str_u32_dict_delete(D, key);
+    }
+    ok = ok && str_u32_dict_insert(D, "key0", 0);  // A deleted key can come back
+    for (uint32_t i = 0; ok && i < 50; i++) {
+        sprintf(key, "key%u", i);
+        uint32_t *value = str_u32_dict_find(D, key);
+        ok = i % 3 == 0 && i != 0 ? value == NULL : value != NULL && *value == i;
+    }
+    report_test("str_u32_dict_insert and str_u32_dict_delete", ok && str_u32_dict_size(D) == 34);
+    str_u32_dict_destroy(D);
+}
+
+// DICT_ORDERED: iteration follows insertion order, skips deleted keys, and puts a re-inserted key last
+void test_ordered_dictionary(void) {
+    Dictionary *D = dictionary_create_ex(7, NULL, DICT_ORDERED);  // Few slots, so chains are long
+    char key[16];
+    bool ok = D != NULL;
+    for (int i = 0; ok && i < 50; i++) {
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_upsert(D, key, NULL);
+        ok = pair != NULL;
+        if (ok) pair->value = (void *)(intptr_t)i;
+    }
+    for (int i = 0; ok && i < 50; i += 3) {
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_delete(D, key);
+        ok = pair != NULL && (intptr_t)pair->value == i;
+        free_pair(pair);
+    }
+    KVPair *again = ok ? dictionary_upsert(D, "key0", NULL) : NULL;
+    ok = again != NULL;
+    if (ok) again->value = (void *)(intptr_t)0;
+
+    // Expect 1, 2, 4, 5, 7, ... 49, then 0
+    DictIter it;
+    KVPair *pair;
+    int expected = 1, seen = 0;
+    if (ok) dictionary_iter_begin(D, &it);
+    while (ok && (pair = dictionary_iter_next(&it)) != NULL) {
+        ok = (intptr_t)pair->value == expected;
+        sprintf(key, "key%d", expected);
+        ok = ok && strcmp(pair->key, key) == 0;
+        seen++;
+        do {
+            expected = expected == 49 ? 0 : expected + 1;
+        } while (expected % 3 == 0 && expected != 0);
+    }
+    report_test("DICT_ORDERED iteration", ok && seen == 34);
+    dictionary_destroy(D);
+}
+
+char evicted_keys[64];  // Keys passed to record_eviction, in order
+
+void record_eviction(KVPair *pair) {
+    strcat(evicted_keys, pair->key);
+}
+
+// DICT_LRU: with capacity 3, the least recently used entry is evicted (finds count as uses), lowering the
+// capacity evicts at once, and the hit/miss/eviction counters add up
+void test_lru(void) {
+    Dictionary *D = dictionary_create_ex(11, NULL, DICT_LRU);
+    evicted_keys[0] = '\0';
+    bool ok = D != NULL && dictionary_set_capacity(D, 3, record_eviction);
+
+    ok = ok && dictionary_upsert(D, "a", NULL) && dictionary_upsert(D, "b", NULL);
+    ok = ok && dictionary_upsert(D, "c", NULL);
+    ok = ok && dictionary_find(D, "a") != NULL && dictionary_find(D, "z") == NULL;  // Order now b c a
+    ok = ok && dictionary_upsert(D, "d", NULL) && dictionary_upsert(D, "e", NULL);  // Evict b, then c
+    ok = ok && dictionary_find(D, "a") != NULL;                                     // Order now d e a
+    ok = ok && dictionary_set_capacity(D, 2, record_eviction);                      // Evict d
+
+    char order[8] = "";
+    DictIter it;
+    KVPair *pair;
+    if (ok) {
+        dictionary_iter_begin(D, &it);
+        while ((pair = dictionary_iter_next(&it)) != NULL && strlen(order) < sizeof(order) - 2) {
+            strcat(order, pair->key);
+        }
+    }
+    DictStats stats;
+    dictionary_stats(D, &stats);
+    ok = ok && strcmp(evicted_keys, "bcd") == 0 && strcmp(order, "ea") == 0 && stats.size == 2
+       && stats.capacity == 2 && stats.hits == 2 && stats.misses == 6 && stats.evictions == 3;  // Misses: a b c z d e
+    report_test("DICT_LRU eviction and counters", ok);
+    dictionary_destroy(D);
+}
+
+// Snapshots: a snapshot keeps seeing the contents it was taken with while the writer inserts, updates and
+// deletes, refuses writes itself, and stays readable after the writer is destroyed
+void test_snapshot(void) {
+    Dictionary *D = dictionary_create(7, NULL);
+    char key[16];
+    bool ok = D != NULL;
+    for (int i = 0; ok && i < 30; i++) {
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_upsert(D, key, NULL);
+        ok = pair != NULL;
+        if (ok) pair->value = (void *)(intptr_t)i;
+    }
+    Dictionary *snapshot = ok ? dictionary_snapshot(D) : NULL;
+    ok = snapshot != NULL;
+
+    // Writer: delete 0..9, renumber 10..19, add 30..39
+    for (int i = 0; ok && i < 10; i++) {
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_delete(D, key);
+        ok = pair != NULL;
+        free_pair(pair);
+    }
+    for (int i = 10; ok && i < 40; i++) {
+        if (i >= 20 && i < 30) continue;
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_upsert(D, key, NULL);
+        ok = pair != NULL;
+        if (ok) pair->value = (void *)(intptr_t)(i + 100);
+    }
+    ok = ok && dictionary_upsert(snapshot, "key99", NULL) == NULL && dictionary_delete(snapshot, "key20") == NULL;
+
+    // The writer sees its changes, the snapshot the original 30 entries
+    for (int i = 0; ok && i < 40; i++) {
+        sprintf(key, "key%d", i);
+        KVPair *now = dictionary_find(D, key);
+        KVPair *then = dictionary_find(snapshot, key);
+        ok = i < 10 ? now == NULL : now != NULL && (intptr_t)now->value == (i < 20 || i >= 30 ? i + 100 : i);
+        ok = ok && (i < 30 ? then != NULL && (intptr_t)then->value == i : then == NULL);
+    }
+    dictionary_destroy(D);
+    for (int i = 0; ok && i < 30; i++) {
+        sprintf(key, "key%d", i);
+        KVPair *then = dictionary_find(snapshot, key);
+        ok = then != NULL && (intptr_t)then->value == i;
+    }
+    report_test("dictionary_snapshot isolation", ok);
+    dictionary_destroy(snapshot);
+}
+
+// dictionary_find_many: every result matches dictionary_find, for present and absent keys, in chained mode
+// with long chains and in DICT_CUCKOO mode
+void test_find_many(int flags, const char *name) {
+    Dictionary *D = dictionary_create_ex(5, NULL, flags);
+    char words[60][16];
+    char *keys[60];
+    KVPair *results[60];
+    bool ok = D != NULL;
+    for (int i = 0; i < 60; i++) {
+        sprintf(words[i], "%s%d", i % 3 == 2 ? "absent" : "word", i);
+        keys[59 - i] = words[i];  // Query in reverse insertion order
+        if (ok && i % 3 != 2) ok = dictionary_upsert(D, words[i], NULL) != NULL;
+    }
+    if (ok) dictionary_find_many(D, keys, 60, results);
+    for (int i = 0; ok && i < 60; i++) {
+        KVPair *expected = dictionary_find(D, keys[i]);
+        ok = results[i] == expected && (expected == NULL) == (strncmp(keys[i], "absent", 6) == 0);
+    }
+    report_test(name, ok);
+    dictionary_destroy(D);
+}
+
+// Start a DICT_CUCKOO dictionary far too small, so inserts have to move resident entries to their other
+// bucket and grow the table many times, then check every key survived with its value
+void test_cuckoo_dictionary(void) {
+    Dictionary *D = dictionary_create_ex(1, NULL, DICT_CUCKOO);
+    char key[16];
+    bool seen[CUCKOO_TEST_KEYS] = {false};
+    bool ok = D != NULL;
+    for (int i = 0; ok && i < CUCKOO_TEST_KEYS; i++) {
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_upsert(D, key, NULL);
+        ok = pair != NULL;
+        if (ok) pair->value = (void *)(intptr_t)i;
+    }
+    for (int i = 0; ok && i < CUCKOO_TEST_KEYS; i++) {
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_find(D, key);
+        ok = pair != NULL && (intptr_t)pair->value == i;
+    }
+    for (int i = 0; ok && i < CUCKOO_TEST_KEYS; i += 2) {
+        sprintf(key, "key%d", i);
+        KVPair *pair = dictionary_delete(D, key);
+        ok = pair != NULL && (intptr_t)pair->value == i && dictionary_find(D, key) == NULL;
+        free_pair(pair);
+    }
+
+    // Iteration visits each remaining (odd) key exactly once
+    DictIter it;
+    KVPair *pair;
+    int count = 0;
+    if (ok) dictionary_iter_begin(D, &it);
+    while (ok && (pair = dictionary_iter_next(&it)) != NULL) {
+        intptr_t i = (intptr_t)pair->value;
+        sprintf(key, "key%d", (int)i);
+        ok = i % 2 == 1 && !seen[i] && strcmp(pair->key, key) == 0;
+        if (ok) seen[i] = true;
+        count++;
+    }
+
+    DictStats stats;
+    if (ok) dictionary_stats(D, &stats);
+    report_test("DICT_CUCKOO growth and deletes", ok && count == CUCKOO_TEST_KEYS / 2 &&
+                stats.size == CUCKOO_TEST_KEYS / 2 && stats.slots >= CUCKOO_TEST_KEYS / 2);
+    dictionary_destroy(D);
+}
+
+// Shared by the threads of the ConcurrentDictionary test
+typedef struct DictStressTest {
+    ConcurrentDictionary *dict;
+    int values[STRESS_WRITERS * STRESS_KEYS];  // values[k] == k; key k maps to &values[k]
+    atomic_int writers_done;
+    atomic_int errors;                         // Failed operations and wrong values seen
+} DictStressTest;
+
+typedef struct DictStressThread {
+    DictStressTest *test;
+    int id;
+} DictStressThread;
+
+// Writer: inserts its own range of keys, then deletes the odd ones again
+void *dict_stress_writer(void *arg) {
+    DictStressThread *thread = arg;
+    DictStressTest *test = thread->test;
+    char key[16];
+    int first = thread->id * STRESS_KEYS;
+
+    for (int k = first; k < first + STRESS_KEYS; k++) {
+        sprintf(key, "key%d", k);
+        if (!concurrent_dictionary_insert(test->dict, key, &test->values[k])) atomic_fetch_add(&test->errors, 1);
+    }
+    for (int k = first + 1; k < first + STRESS_KEYS; k += 2) {
+        sprintf(key, "key%d", k);
+        void *value = NULL;
+        if (!concurrent_dictionary_delete(test->dict, key, &value) || value != &test->values[k]) {
+            atomic_fetch_add(&test->errors, 1);
+        }
+    }
+    atomic_fetch_add(&test->writers_done, 1);
+    return NULL;
+}
+
+// Reader: looks keys up across every writer's range until the writers finish; a key that is found must
+// map to its own value
+void *dict_stress_reader(void *arg) {
+    DictStressThread *thread = arg;
+    DictStressTest *test = thread->test;
+    char key[16];
+    unsigned int k = thread->id;
+
+    while (atomic_load(&test->writers_done) < STRESS_WRITERS) {
+        k = (k * 1103515245u + 12345u) % (STRESS_WRITERS * STRESS_KEYS);
+        sprintf(key, "key%u", k);
+        void *value;
+        if (concurrent_dictionary_find(test->dict, key, &value) && value != &test->values[k]) {
+            atomic_fetch_add(&test->errors, 1);
+        }
+    }
+    return NULL;
+}
+
+// ConcurrentDictionary: writers insert and delete while readers look keys up, then every even key must be
+// present with its value and every odd key absent
+void test_concurrent_dictionary(void) {
+    DictStressTest *test = malloc(sizeof(DictStressTest));
+    bool ok = test != NULL && (test->dict = concurrent_dictionary_create(1024, 16)) != NULL;
+    if (!ok) {
+        report_test("ConcurrentDictionary stress", false);
+        free(test);
+        return;
+    }
+    for (int k = 0; k < STRESS_WRITERS * STRESS_KEYS; k++) test->values[k] = k;
+    atomic_init(&test->writers_done, 0);
+    atomic_init(&test->errors, 0);
+
+    pthread_t threads[STRESS_WRITERS + STRESS_READERS];
+    bool started[STRESS_WRITERS + STRESS_READERS];
+    DictStressThread args[STRESS_WRITERS + STRESS_READERS];
+    for (int t = 0; t < STRESS_WRITERS + STRESS_READERS; t++) {
+        void *(*run)(void *) = t < STRESS_WRITERS ? dict_stress_writer : dict_stress_reader;
+        args[t].test = test;
+        args[t].id = t < STRESS_WRITERS ? t : t - STRESS_WRITERS;
+        started[t] = pthread_create(&threads[t], NULL, run, &args[t]) == 0;
+        if (!started[t]) {
+            run(&args[t]);  // No thread to spare: run it here
+        }
+    }
+    for (int t = 0; t < STRESS_WRITERS + STRESS_READERS; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+    }
+
+    char key[16];
+    ok = atomic_load(&test->errors) == 0
+      && concurrent_dictionary_size(test->dict) == STRESS_WRITERS * STRESS_KEYS / 2;
+    for (int k = 0; ok && k < STRESS_WRITERS * STRESS_KEYS; k++) {
+        sprintf(key, "key%d", k);
+        void *value = NULL;
+        bool found = concurrent_dictionary_find(test->dict, key, &value);
+        ok = k % 2 == 0 ? found && value == &test->values[k] : !found;
+    }
+    report_test("ConcurrentDictionary stress", ok);
+    concurrent_dictionary_destroy(test->dict);
+    free(test);
+}
+
+int main(void) {
+    test_typed_dictionary();
+    test_ordered_dictionary();
+    test_find_many(0, "dictionary_find_many");
+    test_find_many(DICT_CUCKOO, "dictionary_find_many (DICT_CUCKOO)");
+    test_cuckoo_dictionary();
+    test_snapshot();
+    test_lru();
+    test_concurrent_dictionary();
+
+    nodePoolDestroy();  // Every list is gone: release the node slabs
+    return failed_tests > 0;
+}
@@ -0,0 +1,103 @@
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+#include "Stack.h"
+
+#ifdef STACK_ARRAY  // Otherwise Stack.c implements Stack.h
+
+#define INITIAL_CAPACITY 16  // Entries allocated by the first push
+
+// Resizes the array to exactly capacity entries
+static bool resize(StackPtr S, int capacity) {
+    void **items = (void **)realloc(S->items, capacity * sizeof(void *));
+    if (items == NULL) return false;
+    S->items = items;
+    S->capacity = capacity;
+    return true;
+}
+
+// Constructor for the Stack ADT
+StackPtr createStack(void (*dataPrinter)(void *data)) {
+    StackPtr S = (StackPtr)malloc(sizeof(StackObj));
+    if (S) {
+        S->items = NULL;
+        S->capacity = 0;
+        S->dataPrinter = dataPrinter;
+        S->length = 0;
+    }
+    return S;
+}
+
+// Destructor for the Stack ADT
+void destroyStack(StackPtr *pS) {
+    if (pS && *pS) {
+        free((*pS)->items);
+        free(*pS);
+        *pS = NULL;
+    }
+}
+
+// Returns the length of the stack
+int lengthStack(StackPtr S) {
+    if (S == NULL) return -1;
+    return S->length;
+}
+
+// Prints the data in the stack, from the top down like the linked stack
+void printStack(StackPtr S) {
+    if (S == NULL || S->dataPrinter == NULL) return;
+    
+    for (int i = S->length - 1; i >= 0; i--) {
+        S->dataPrinter(S->items[i]);
+    }
+}
+
+// Retrieves the data at the top of the stack without removing it
+void *peekStack(StackPtr S) {
+    if (S == NULL || S->length == 0) return NULL;
+    return S->items[S->length - 1];
+}
+
+// Pushes an entry onto the stack, doubling the array when it is full (amortized O(1) per push)
+bool pushStack(StackPtr S, void *data) {
+    if (S == NULL) return false;
+    
+    if (S->length == S->capacity) {
+        if (S->capacity > INT_MAX / 2) return false;
+        if (!resize(S, S->capacity ? S->capacity * 2 : INITIAL_CAPACITY)) return false;
+    }
+    
+    S->items[S->length++] = data;
+    return true;
+}
+
+// Pops the entry from the top of the stack and returns the data from that entry.
+// The array keeps its capacity; shrinkStack gives it back.
+void *popStack(StackPtr S) {
+    if (S == NULL || S->length == 0) return NULL;
+    return S->items[--S->length];
+}
+
+// Grows the array to at least capacity entries in one step
+bool reserveStack(StackPtr S, int capacity) {
+    if (S == NULL || capacity < 0) return false;
+    if (capacity <= S->capacity) return true;
+    return resize(S, capacity);
+}
+
+// Trims the array to the current length (freeing it entirely when the stack is empty)
+void shrinkStack(StackPtr S) {
+    if (S == NULL || S->capacity == S->length) return;
+    
+    if (S->length == 0) {
+        free(S->items);
+        S->items = NULL;
+        S->capacity = 0;
+        return;
+    }
+    resize(S, S->length);  // On failure the larger array is simply kept
+}
+
+#endif
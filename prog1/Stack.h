@@ -9,11 +9,21 @@
 // ---------------------------------------------------
 
 
+#ifdef STACK_ARRAY
+// Array-backed stack (ArrayStack.c): entries live in one growable array, top at items[length - 1]
+typedef struct StackObj{
+    void **items; // Entries from the bottom of the stack up
+    int capacity; // Entries items has room for
+    void (*dataPrinter)(void *data); // Function to print the data in stack
+    int length; // Keeps track of the stack's length
+} StackObj;
+#else
 typedef struct StackObj{
     NodePtr top; // Points to the top of the stack
     void (*dataPrinter)(void *data); // Function to print the data in stack
     int length; // Keeps track of the stack's length
 } StackObj;
+#endif
 
 typedef struct StackObj* StackPtr;
 
@@ -79,5 +89,25 @@ bool pushStack(StackPtr S, void *data);
  */
 void *popStack(StackPtr S);
 
+// Capacity functions --------------------------------
+
+/**
+ * @brief Makes room for at least capacity entries, so that pushes up to that depth do not allocate.
+ * The linked stack allocates per push and treats this as a hint only.
+ * 
+ * @param S The stack to reserve room in
+ * @param capacity The number of entries to make room for
+ * @return bool True if the room is available, False on allocation failure
+ */
+bool reserveStack(StackPtr S, int capacity);
+
+/**
+ * @brief Gives back memory the stack no longer needs, trimming the array-backed stack's capacity down to
+ * its length. The linked stack holds no spare room, so this does nothing there.
+ * 
+ * @param S The stack to shrink
+ */
+void shrinkStack(StackPtr S);
+
 #endif // STACK_H
 
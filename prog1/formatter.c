@@ -1,5 +1,6 @@
 #include "List.h"
 #include "Stack.h"
+#include "NodePool.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -9,9 +10,6 @@
 #define MAX_LINE_LENGTH 1000
 #define MAX_FILENAME_LENGTH 100
 
-// Current position in list for iteration
-static int currentPos = 0;
-
 /*
  * Function: printString
  * -------------------
@@ -118,12 +116,10 @@ void formatText(ListPtr wordList, FILE* output, char align, int width) {
     int lineLen = 0;
     int wordCount = 0;
     
-    // Reset position counter for list traversal
-    currentPos = 0;
-    
-    // Process each word in the list
-    while (currentPos < lengthList(wordList)) {
-        char* word = (char*)getList(wordList, currentPos);
+    // Process each word in the list, walking it once with a cursor
+    ListCursor cursor;
+    for (beginList(wordList, &cursor); !endList(&cursor); nextList(&cursor)) {
+        char* word = (char*)currentList(&cursor);
         int wordLen = strlen(word);
         
         // If this word would exceed line width, print current line and start new one
@@ -152,8 +148,6 @@ void formatText(ListPtr wordList, FILE* output, char align, int width) {
         strcat(line, word);
         lineLen += wordLen;
         wordCount++;
-        
-        currentPos++;
     }
     
     // Print last line if not empty
@@ -180,8 +174,9 @@ void cleanupWordList(ListPtr *wordList) {
     if (*wordList == NULL) return;
     
     // Free each word in the list
-    for (int i = 0; i < lengthList(*wordList); i++) {
-        char* word = (char*)getList(*wordList, i);
+    ListCursor cursor;
+    for (beginList(*wordList, &cursor); !endList(&cursor); nextList(&cursor)) {
+        char* word = (char*)currentList(&cursor);
         if (word) free(word);
     }
     destroyList(wordList);
@@ -293,5 +288,16 @@ int main(int argc, char **argv) {
     }
     destroyStack(&fileStack);
     
+    // Node pool usage (build with -DDEBUG)
+    #ifdef DEBUG
+    NodePoolStats stats;
+    nodePoolStats(&stats);
+    printf("Node pool: %ld hits, %ld misses, %ld frees, %ld slabs\n",
+           stats.hits, stats.misses, stats.frees, stats.slabs);
+    #endif
+    
+    // Every list and stack is gone: release the node slabs
+    nodePoolDestroy();
+    
     return 0;
 }
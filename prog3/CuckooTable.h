@@ -0,0 +1,107 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "Dictionary.h"
+
+#ifndef CUCKOO_HEADER
+#define CUCKOO_HEADER
+
+#define CUCKOO_SLOTS 4  // Entries per bucket
+
+typedef struct CuckooTable CuckooTable;
+
+#endif
+
+// -------------------------------
+// Function headers
+// -------------------------------
+
+/**
+ * @brief Creates a bucketized cuckoo hash table of KVPair pointers, used by Dictionary in DICT_CUCKOO mode.
+ * Every key lives in one of its two candidate buckets of CUCKOO_SLOTS entries, so a lookup probes at most
+ * two buckets (two cache lines) no matter how full the table is. The table does not own the KVPairs.
+ * 
+ * @param capacity Number of entries to size the table for (it grows as needed)
+ * @return CuckooTable* The new table, or NULL on allocation failure
+ */
+CuckooTable *cuckoo_create(int capacity);
+
+/**
+ * @brief Destroys the table. The KVPairs it points to are not freed.
+ * 
+ * @param T The table to destroy
+ */
+void cuckoo_destroy(CuckooTable *T);
+
+/**
+ * @brief Hashes a key for the other cuckoo_* functions. The hash does not depend on the table size, so it
+ * stays valid while the table grows.
+ * 
+ * @param key The key to hash
+ * @return uint64_t The 64-bit hash
+ */
+uint64_t cuckoo_hash(char *key);
+
+/**
+ * @brief Starts loading both candidate buckets of a hash into cache, ahead of cuckoo_find.
+ * 
+ * @param T The table
+ * @param hash The hash from cuckoo_hash
+ */
+void cuckoo_prefetch(CuckooTable *T, uint64_t hash);
+
+/**
+ * @brief Finds the entry for a key, probing at most two buckets.
+ * 
+ * @param T The table to search
+ * @param key The key to find
+ * @param hash cuckoo_hash(key)
+ * @return KVPair* The entry, or NULL if the key is not in the table
+ */
+KVPair *cuckoo_find(CuckooTable *T, char *key, uint64_t hash);
+
+/**
+ * @brief Adds an entry whose key is not in the table yet. When both buckets are full, resident entries are
+ * moved to their other bucket to make room; if no room turns up within a bounded number of moves, the
+ * table doubles and every entry is placed again.
+ * 
+ * @param T The table to insert into
+ * @param pair The entry to add
+ * @param hash cuckoo_hash(pair->key)
+ * @return true If the entry was added, false on allocation failure (the table is left unchanged)
+ */
+bool cuckoo_insert(CuckooTable *T, KVPair *pair, uint64_t hash);
+
+/**
+ * @brief Removes the entry for a key.
+ * 
+ * @param T The table to remove from
+ * @param key The key to remove
+ * @param hash cuckoo_hash(key)
+ * @return KVPair* The removed entry, or NULL if the key is not in the table
+ */
+KVPair *cuckoo_remove(CuckooTable *T, char *key, uint64_t hash);
+
+/**
+ * @brief Walks the entries in table order.
+ * 
+ * @param T The table
+ * @param pos In/out position: start at 0, then pass back the value left by the previous call
+ * @return KVPair* The next entry, or NULL at the end
+ */
+KVPair *cuckoo_next(CuckooTable *T, int *pos);
+
+/**
+ * @brief Gets the number of entry slots (buckets * CUCKOO_SLOTS)
+ * 
+ * @param T The table
+ * @return int The number of slots
+ */
+int cuckoo_slots(CuckooTable *T);
+
+/**
+ * @brief Counts buckets by occupancy, for table health stats.
+ * 
+ * @param T The table
+ * @param histogram Output: histogram[k] is the number of buckets holding k entries, for k = 0..CUCKOO_SLOTS
+ */
+void cuckoo_occupancy(CuckooTable *T, int *histogram);
@@ -0,0 +1,595 @@
+#include "FrozenDictionary.h"
+#include "HashTable.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define KEYS_PER_BUCKET 4         // Average bucket size; the displacement table costs ~1 byte per key
+#define LOAD_FACTOR_INV 10        // One spare slot per 9 keys: load factor 0.9, so placement runs in linear time
+#define MAX_DISPLACEMENT 1000000  // Give up on a seed if a bucket cannot be placed within this many tries
+#define MAX_SEEDS 16              // Number of hash seeds to try before failing
+#define FIND_BATCH 16             // Keys in flight per round of frozen_dictionary_find_many
+#define FILE_MAGIC "FROZDICT"     // First 8 bytes of a saved frozen dictionary
+#define FILE_VERSION 2            // Bumped on format changes; also rejects files of the other byte order
+#define EMPTY_SLOT UINT32_MAX     // Key offset of a table slot that holds no key
+#define POOL_CHUNK 65536          // Bytes read at a time from a FrozenBuilder's key file
+
+// One table slot: the key's offset in key_pool (or EMPTY_SLOT) and its value, 8 bytes in all
+typedef struct FrozenEntry {
+    uint32_t key;
+    uint32_t value;
+} FrozenEntry;
+
+typedef struct FrozenDictionary {
+    uint32_t size;          // Number of entries
+    uint32_t slots;         // Number of table slots, about size / 0.9
+    uint32_t buckets;       // Number of displacement buckets
+    uint32_t pool_size;     // Bytes in key_pool
+    uint64_t seed;          // Seed the table was built with
+    uint32_t *displacement; // Per-bucket displacement chosen at build time
+    FrozenEntry *entries;   // Table of slots entries
+    uint32_t *key_index;    // key_index[v] is the key_pool offset of the key with value v (dense values only)
+    char *key_pool;         // All keys packed back to back, NUL-terminated
+    void *map;              // Mapping the arrays above point into (frozen_dictionary_open only)
+    size_t map_size;
+} FrozenDictionary;
+
+// Header of a saved frozen dictionary. It is followed by the displacement table, the entry table, the
+// key index (if present) and the key pool, in that order. Every section is a multiple of 4 bytes long
+// except the trailing key pool, and every pointer in the format is an offset, so the file can be mapped
+// at any address and used in place.
+typedef struct FrozenFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t size;
+    uint32_t buckets;
+    uint32_t pool_size;
+    uint64_t seed;
+    uint32_t has_key_index;
+    uint32_t slots;
+} FrozenFileHeader;
+
+// 64-bit finalizer (splitmix64) used to spread bits for bucket and slot selection.
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Seeded FNV-1a over the key bytes, finalized with mix64.
+static inline uint64_t frozen_hash(const char *key, size_t len, uint64_t seed) {
+    uint64_t h = 0xcbf29ce484222325ULL ^ seed;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)key[i];
+        h *= 0x100000001b3ULL;
+    }
+    return mix64(h);
+}
+
+static inline uint32_t bucket_of(uint64_t h, uint32_t buckets) {
+    return (uint32_t)((h >> 32) % buckets);
+}
+
+static inline uint32_t slot_of(uint64_t h, uint32_t displacement, uint32_t slots) {
+    return (uint32_t)(mix64(h ^ ((uint64_t)displacement * 0x9e3779b97f4a7c15ULL)) % slots);
+}
+
+// Tries to place every key with the given seed. Fills F->displacement and slot_of_key on success.
+// The table keeps a tenth of its slots spare, so even the last buckets find free slots within a few
+// tries and placement takes expected linear time.
+static int place_keys(FrozenDictionary *F, uint64_t *hashes, uint32_t *slot_of_key) {
+    uint32_t n = F->size;
+    uint32_t m = F->slots;
+    uint32_t r = F->buckets;
+    int ok = 0;
+    
+    // Group keys by bucket: counting sort of key indices by bucket
+    uint32_t *bucket_start = calloc(r + 1, sizeof(uint32_t));
+    uint32_t *bucket_keys = malloc(n * sizeof(uint32_t));
+    uint32_t *order = malloc(r * sizeof(uint32_t));
+    unsigned char *taken = calloc(m, 1);
+    uint32_t *slots = malloc(n * sizeof(uint32_t));
+    if (!bucket_start || !bucket_keys || !order || !taken || !slots) goto done;
+    
+    for (uint32_t i = 0; i < n; i++) {
+        bucket_start[bucket_of(hashes[i], r) + 1]++;
+    }
+    uint32_t max_bucket = 0;
+    for (uint32_t b = 0; b < r; b++) {
+        if (bucket_start[b + 1] > max_bucket) max_bucket = bucket_start[b + 1];
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    uint32_t *fill = malloc(r * sizeof(uint32_t));
+    if (fill == NULL) goto done;
+    memcpy(fill, bucket_start, r * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+        bucket_keys[fill[bucket_of(hashes[i], r)]++] = i;
+    }
+    free(fill);
+    
+    // Place the largest buckets first, while the table is still mostly empty
+    uint32_t count = 0;
+    for (uint32_t want = max_bucket; want > 0; want--) {
+        for (uint32_t b = 0; b < r; b++) {
+            if (bucket_start[b + 1] - bucket_start[b] == want) order[count++] = b;
+        }
+    }
+    
+    for (uint32_t o = 0; o < count; o++) {
+        uint32_t b = order[o];
+        uint32_t first = bucket_start[b];
+        uint32_t len = bucket_start[b + 1] - first;
+        uint32_t d;
+        
+        for (d = 0; d < MAX_DISPLACEMENT; d++) {
+            // All keys of the bucket must land on free slots, distinct from each other
+            uint32_t k;
+            for (k = 0; k < len; k++) {
+                uint32_t s = slot_of(hashes[bucket_keys[first + k]], d, m);
+                if (taken[s]) break;
+                taken[s] = 1;
+                slots[k] = s;
+            }
+            if (k == len) break;
+            while (k-- > 0) taken[slots[k]] = 0;
+        }
+        if (d == MAX_DISPLACEMENT) goto done;
+        
+        F->displacement[b] = d;
+        for (uint32_t k = 0; k < len; k++) {
+            slot_of_key[bucket_keys[first + k]] = slots[k];
+        }
+    }
+    ok = 1;
+    
+done:
+    free(bucket_start);
+    free(bucket_keys);
+    free(order);
+    free(taken);
+    free(slots);
+    return ok;
+}
+
+// Hashes keys packed back to back, NUL-terminated, as they are in a key pool. The bytes may come in pieces
+// of any size; hashes[i] ends up as frozen_hash of the i-th key.
+typedef struct PoolHasher {
+    uint64_t seed;
+    uint64_t h;          // FNV-1a state of the key being read
+    uint32_t count;      // Keys hashed so far
+    uint64_t *hashes;
+} PoolHasher;
+
+static void pool_hasher_start(PoolHasher *p, uint64_t seed, uint64_t *hashes) {
+    p->seed = seed;
+    p->h = 0xcbf29ce484222325ULL ^ seed;
+    p->count = 0;
+    p->hashes = hashes;
+}
+
+static void pool_hasher_feed(PoolHasher *p, const char *bytes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (bytes[i] == '\0') {
+            p->hashes[p->count++] = mix64(p->h);
+            p->h = 0xcbf29ce484222325ULL ^ p->seed;
+        } else {
+            p->h ^= (unsigned char)bytes[i];
+            p->h *= 0x100000001b3ULL;
+        }
+    }
+}
+
+// Fills hashes with every key's hash under seed, reading the keys from wherever they are kept
+typedef bool (*HashKeys)(void *ctx, uint64_t seed, uint64_t *hashes);
+
+static bool hash_key_pool(void *ctx, uint64_t seed, uint64_t *hashes) {
+    FrozenDictionary *F = (FrozenDictionary *)ctx;
+    PoolHasher p;
+    pool_hasher_start(&p, seed, hashes);
+    pool_hasher_feed(&p, F->key_pool, F->pool_size);
+    return true;
+}
+
+// Builds the table for F->size keys: source[i] holds the i-th key's pool offset and its value. Allocates
+// and fills F->displacement, F->entries and (for dense values) F->key_index.
+static bool build_table(FrozenDictionary *F, FrozenEntry *source, HashKeys hash_keys, void *ctx) {
+    uint32_t n = F->size;
+    F->slots = (uint32_t)((uint64_t)n * LOAD_FACTOR_INV / (LOAD_FACTOR_INV - 1) + 1);
+    F->buckets = n / KEYS_PER_BUCKET + 1;
+    F->displacement = calloc(F->buckets, sizeof(uint32_t));
+    uint64_t *hashes = malloc((n ? n : 1) * sizeof(uint64_t));       // Hash of each source entry's key
+    uint32_t *slot_of_key = malloc((n ? n : 1) * sizeof(uint32_t));  // Table slot chosen for each source entry
+    bool placed = false;
+    
+    // Find a seed for which every bucket can be displaced onto free slots
+    if (F->displacement && hashes && slot_of_key) {
+        for (uint64_t seed = 0; seed < MAX_SEEDS && !placed; seed++) {
+            F->seed = mix64(seed + 1);
+            if (!hash_keys(ctx, F->seed, hashes)) break;
+            placed = place_keys(F, hashes, slot_of_key);
+        }
+    }
+    free(hashes);
+    
+    // The table is allocated only now, once the hashes are gone, to keep the peak down
+    F->entries = placed ? malloc(F->slots * sizeof(FrozenEntry)) : NULL;
+    if (F->entries == NULL) {
+        free(slot_of_key);
+        return false;
+    }
+    for (uint32_t s = 0; s < F->slots; s++) {
+        F->entries[s].key = EMPTY_SLOT;
+        F->entries[s].value = 0;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        F->entries[slot_of_key[i]] = source[i];
+    }
+    free(slot_of_key);
+    
+    // Values that number the keys 0..size-1 (like token IDs) also get a value → key index
+    F->key_index = malloc((n ? n : 1) * sizeof(uint32_t));
+    if (F->key_index == NULL) return false;
+    memset(F->key_index, 0xff, (n ? n : 1) * sizeof(uint32_t));
+    for (uint32_t i = 0; i < n; i++) {
+        if (source[i].value >= n || F->key_index[source[i].value] != UINT32_MAX) {
+            free(F->key_index);
+            F->key_index = NULL;
+            break;
+        }
+        F->key_index[source[i].value] = source[i].key;
+    }
+    return true;
+}
+
+FrozenDictionary *frozen_dictionary_create(StrU32Dict *D) {
+    if (D == NULL) return NULL;
+    
+    FrozenDictionary *F = calloc(1, sizeof(FrozenDictionary));
+    if (F == NULL) return NULL;
+    
+    FrozenEntry *source = NULL;    // Entries in iteration order, before placement
+    
+    // First pass: count entries and key bytes
+    StrU32DictIter it;
+    StrU32DictEntry *pair;
+    size_t pool_size = 0;
+    uint32_t n = 0;
+    str_u32_dict_iter_begin(D, &it);
+    while ((pair = str_u32_dict_iter_next(&it)) != NULL) {
+        pool_size += strlen(str_u32_dict_key(D, pair)) + 1;
+        n++;
+    }
+    if (pool_size >= EMPTY_SLOT) goto fail;  // Key offsets are 32-bit
+    
+    F->size = n;
+    F->pool_size = (uint32_t)pool_size;
+    F->key_pool = malloc(pool_size ? pool_size : 1);
+    source = malloc((n ? n : 1) * sizeof(FrozenEntry));
+    if (!F->key_pool || !source) goto fail;
+    
+    // Second pass: pack the keys into the pool
+    uint32_t offset = 0;
+    uint32_t i = 0;
+    str_u32_dict_iter_begin(D, &it);
+    while ((pair = str_u32_dict_iter_next(&it)) != NULL) {
+        char *key = str_u32_dict_key(D, pair);
+        size_t len = strlen(key);
+        memcpy(F->key_pool + offset, key, len + 1);
+        source[i].key = offset;
+        source[i].value = pair->value;
+        offset += len + 1;
+        i++;
+    }
+    
+    if (!build_table(F, source, hash_key_pool, F)) goto fail;
+    free(source);
+    return F;
+    
+fail:
+    free(source);
+    frozen_dictionary_destroy(F);
+    return NULL;
+}
+
+void frozen_dictionary_destroy(FrozenDictionary *F) {
+    if (F == NULL) return;
+    if (F->map != NULL) {
+        munmap(F->map, F->map_size);
+    } else {
+        free(F->displacement);
+        free(F->entries);
+        free(F->key_index);
+        free(F->key_pool);
+    }
+    free(F);
+}
+
+// Writes F to path in the format frozen_dictionary_open maps. The key pool comes from F->key_pool, or from
+// the start of pool_file if that is not NULL.
+static bool write_file(FrozenDictionary *F, const char *path, FILE *pool_file) {
+    FrozenFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+    header.version = FILE_VERSION;
+    header.size = F->size;
+    header.buckets = F->buckets;
+    header.pool_size = F->pool_size;
+    header.seed = F->seed;
+    header.has_key_index = F->key_index != NULL;
+    header.slots = F->slots;
+    
+    // Write next to the destination and rename over it, so processes that still map the old
+    // file keep reading intact pages
+    char *tmp = malloc(strlen(path) + 5);
+    if (tmp == NULL) return false;
+    sprintf(tmp, "%s.tmp", path);
+    
+    FILE *fp = fopen(tmp, "wb");
+    if (fp == NULL) {
+        free(tmp);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+           && fwrite(F->displacement, sizeof(uint32_t), F->buckets, fp) == F->buckets
+           && fwrite(F->entries, sizeof(FrozenEntry), F->slots, fp) == F->slots
+           && (F->key_index == NULL || fwrite(F->key_index, sizeof(uint32_t), F->size, fp) == F->size);
+    if (pool_file == NULL) {
+        ok = ok && fwrite(F->key_pool, 1, F->pool_size, fp) == F->pool_size;
+    } else {
+        char buffer[POOL_CHUNK];
+        size_t copied = 0, got;
+        ok = ok && fseek(pool_file, 0, SEEK_SET) == 0;
+        while (ok && (got = fread(buffer, 1, sizeof(buffer), pool_file)) > 0) {
+            ok = fwrite(buffer, 1, got, fp) == got;
+            copied += got;
+        }
+        ok = ok && !ferror(pool_file) && copied == F->pool_size;
+    }
+    ok = fclose(fp) == 0 && ok;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) remove(tmp);
+    free(tmp);
+    return ok;
+}
+
+bool frozen_dictionary_save(FrozenDictionary *F, const char *path) {
+    if (F == NULL || path == NULL) return false;
+    return write_file(F, path, NULL);
+}
+
+FrozenDictionary *frozen_dictionary_open(const char *path) {
+    if (path == NULL) return NULL;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(FrozenFileHeader)) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);  // The mapping keeps the file alive
+    if (map == MAP_FAILED) return NULL;
+    
+    // Only the header is checked, so opening stays O(1) and pages are read on first use.
+    // The file is trusted to have been written by frozen_dictionary_save.
+    FrozenFileHeader *header = (FrozenFileHeader *)map;
+    size_t expected = sizeof(FrozenFileHeader)
+                    + (size_t)header->buckets * sizeof(uint32_t)
+                    + (size_t)header->slots * sizeof(FrozenEntry)
+                    + (header->has_key_index ? (size_t)header->size * sizeof(uint32_t) : 0)
+                    + header->pool_size;
+    char *base = (char *)map;
+    FrozenDictionary *F = NULL;
+    if (memcmp(header->magic, FILE_MAGIC, sizeof(header->magic)) != 0 || header->version != FILE_VERSION
+        || header->buckets == 0 || header->slots <= header->size || expected != (size_t)st.st_size
+        || (header->pool_size > 0 && base[st.st_size - 1] != '\0')
+        || (F = calloc(1, sizeof(FrozenDictionary))) == NULL) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    
+    F->size = header->size;
+    F->slots = header->slots;
+    F->buckets = header->buckets;
+    F->pool_size = header->pool_size;
+    F->seed = header->seed;
+    F->map = map;
+    F->map_size = st.st_size;
+    
+    // Point the arrays at their sections of the mapping
+    base += sizeof(FrozenFileHeader);
+    F->displacement = (uint32_t *)base;
+    base += (size_t)F->buckets * sizeof(uint32_t);
+    F->entries = (FrozenEntry *)base;
+    base += (size_t)F->slots * sizeof(FrozenEntry);
+    if (header->has_key_index) {
+        F->key_index = (uint32_t *)base;
+        base += (size_t)F->size * sizeof(uint32_t);
+    }
+    F->key_pool = base;
+    return F;
+}
+
+bool frozen_dictionary_find(FrozenDictionary *F, char *key, uint32_t *value) {
+    if (F == NULL || key == NULL || F->size == 0) return false;
+    
+    // One hash, one probe, one comparison
+    uint64_t h = frozen_hash(key, strlen(key), F->seed);
+    uint32_t slot = slot_of(h, F->displacement[bucket_of(h, F->buckets)], F->slots);
+    FrozenEntry *entry = &F->entries[slot];
+    
+    if (entry->key == EMPTY_SLOT || strcmp(F->key_pool + entry->key, key) != 0) return false;
+    if (value != NULL) *value = entry->value;
+    return true;
+}
+
+// Batched lookup behind frozen_dictionary_find_many and frozen_dictionary_find_many_len. With lens NULL the
+// keys are NUL-terminated; otherwise keys[i] is lens[i] bytes long and need not be terminated.
+static void find_batched(FrozenDictionary *F, char **keys, const uint32_t *lens, int n, uint32_t *values) {
+    if (values == NULL) return;
+    
+    uint64_t hash[FIND_BATCH];
+    uint32_t slot[FIND_BATCH];
+    
+    for (int base = 0; base < n; base += FIND_BATCH) {
+        int count = n - base < FIND_BATCH ? n - base : FIND_BATCH;
+        
+        if (F == NULL || keys == NULL || F->size == 0) {
+            for (int i = 0; i < count; i++) values[base + i] = FROZEN_MISSING;
+            continue;
+        }
+        
+        // Pass 1: hash every key and start loading its displacement
+        for (int i = 0; i < count; i++) {
+            char *key = keys[base + i];
+            if (key == NULL) continue;
+            hash[i] = frozen_hash(key, lens ? lens[base + i] : strlen(key), F->seed);
+            HT_PREFETCH(&F->displacement[bucket_of(hash[i], F->buckets)]);
+        }
+        
+        // Pass 2: pick each key's slot and start loading the entry
+        for (int i = 0; i < count; i++) {
+            if (keys[base + i] == NULL) continue;
+            slot[i] = slot_of(hash[i], F->displacement[bucket_of(hash[i], F->buckets)], F->slots);
+            HT_PREFETCH(&F->entries[slot[i]]);
+        }
+        
+        // Pass 3: start loading the stored keys
+        for (int i = 0; i < count; i++) {
+            if (keys[base + i] == NULL || F->entries[slot[i]].key == EMPTY_SLOT) continue;
+            HT_PREFETCH(F->key_pool + F->entries[slot[i]].key);
+        }
+        
+        // Pass 4: compare
+        for (int i = 0; i < count; i++) {
+            char *key = keys[base + i];
+            FrozenEntry *entry = key == NULL ? NULL : &F->entries[slot[i]];
+            if (entry != NULL && entry->key == EMPTY_SLOT) entry = NULL;
+            bool match = false;
+            if (entry != NULL && lens == NULL) {
+                match = strcmp(F->key_pool + entry->key, key) == 0;
+            } else if (entry != NULL) {
+                char *stored = F->key_pool + entry->key;
+                match = strnlen(stored, lens[base + i] + 1) == lens[base + i]
+                     && memcmp(stored, key, lens[base + i]) == 0;
+            }
+            values[base + i] = match ? entry->value : FROZEN_MISSING;
+        }
+    }
+}
+
+void frozen_dictionary_find_many(FrozenDictionary *F, char **keys, int n, uint32_t *values) {
+    find_batched(F, keys, NULL, n, values);
+}
+
+void frozen_dictionary_find_many_len(FrozenDictionary *F, char **keys, const uint32_t *lens, int n,
+                                     uint32_t *values) {
+    find_batched(F, keys, lens, n, values);
+}
+
+char *frozen_dictionary_key(FrozenDictionary *F, uint32_t value) {
+    if (F == NULL || F->key_index == NULL || value >= F->size) return NULL;
+    return F->key_pool + F->key_index[value];
+}
+
+int frozen_dictionary_size(FrozenDictionary *F) {
+    if (F == NULL) return 0;
+    return (int)F->size;
+}
+
+// A frozen dictionary under construction: its keys go to a temporary file as they arrive, and only the
+// fixed-size (key offset, value) pairs stay in memory
+typedef struct FrozenBuilder {
+    FILE *pool;           // Key pool so far: keys back to back, NUL-terminated
+    uint32_t pool_size;   // Bytes written to pool
+    FrozenEntry *source;  // Key offset and value of each key, in the order added
+    uint32_t count;
+    uint32_t capacity;
+    bool failed;
+} FrozenBuilder;
+
+// Hashes the keys by reading the builder's key file from the start
+static bool hash_key_file(void *ctx, uint64_t seed, uint64_t *hashes) {
+    FrozenBuilder *B = (FrozenBuilder *)ctx;
+    char buffer[POOL_CHUNK];
+    size_t got;
+    PoolHasher p;
+    pool_hasher_start(&p, seed, hashes);
+    if (fseek(B->pool, 0, SEEK_SET) != 0) return false;
+    while ((got = fread(buffer, 1, sizeof(buffer), B->pool)) > 0) {
+        pool_hasher_feed(&p, buffer, got);
+    }
+    return !ferror(B->pool) && p.count == B->count;
+}
+
+FrozenBuilder *frozen_builder_create(void) {
+    FrozenBuilder *B = calloc(1, sizeof(FrozenBuilder));
+    if (B == NULL) return NULL;
+    
+    B->pool = tmpfile();
+    if (B->pool == NULL) {
+        free(B);
+        return NULL;
+    }
+    return B;
+}
+
+void frozen_builder_destroy(FrozenBuilder *B) {
+    if (B == NULL) return;
+    fclose(B->pool);
+    free(B->source);
+    free(B);
+}
+
+bool frozen_builder_add(FrozenBuilder *B, char *key, uint32_t value) {
+    if (B == NULL || key == NULL || B->failed) return false;
+    
+    size_t len = strlen(key) + 1;
+    if (len >= EMPTY_SLOT - B->pool_size || B->count == UINT32_MAX) {
+        B->failed = true;  // Key offsets and counts are 32-bit
+        return false;
+    }
+    if (B->count == B->capacity) {
+        uint32_t capacity = B->capacity ? B->capacity * 2 : 1024;
+        FrozenEntry *source = realloc(B->source, capacity * sizeof(FrozenEntry));
+        if (source == NULL) {
+            B->failed = true;
+            return false;
+        }
+        B->source = source;
+        B->capacity = capacity;
+    }
+    if (fwrite(key, 1, len, B->pool) != len) {
+        B->failed = true;
+        return false;
+    }
+    B->source[B->count].key = B->pool_size;
+    B->source[B->count].value = value;
+    B->count++;
+    B->pool_size += len;
+    return true;
+}
+
+bool frozen_builder_save(FrozenBuilder *B, const char *path) {
+    if (B == NULL || path == NULL || B->failed || fflush(B->pool) != 0) return false;
+    
+    // The table is built exactly as frozen_dictionary_create builds it, minus the in-memory key pool
+    FrozenDictionary F;
+    memset(&F, 0, sizeof(F));
+    F.size = B->count;
+    F.pool_size = B->pool_size;
+    bool ok = build_table(&F, B->source, hash_key_file, B) && write_file(&F, path, B->pool);
+    free(F.displacement);
+    free(F.entries);
+    free(F.key_index);
+    return ok;
+}
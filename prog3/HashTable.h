@@ -14,3 +14,10 @@ unsigned long ht_string2int(char *str);
  * @return unsigned int 
  */
 unsigned int ht_hash(char *key, unsigned int slots);
+
+// Hints the CPU to start loading addr into cache ahead of use (no-op without the GCC/Clang builtin).
+#if defined(__GNUC__)
+#define HT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HT_PREFETCH(addr) ((void)(addr))
+#endif
@@ -14,14 +14,51 @@ typedef struct NodeObj{
 
 typedef struct NodeObj* NodePtr;
 
+#ifdef LIST_UNROLLED
+// Unrolled list (UnrolledList.c): each chunk holds up to LIST_CHUNK entries, so a chunk with its link and
+// count fills two 64-byte cache lines, and a walk touches one chunk per LIST_CHUNK entries.
+#define LIST_CHUNK 14
+
+typedef struct ListChunk{
+    struct ListChunk* next;
+    int count;                  // Entries in use: data[0..count-1]
+    void *data[LIST_CHUNK];
+} ListChunk;
+
+typedef struct ListObj{
+    ListChunk* head;
+    ListChunk* tail;
+    void (*dataPrinter)(void *data);
+    int length;
+} ListObj;
+
+typedef struct ListObj* ListPtr;
+
+// Position in a list for walking it without getList (see beginList)
+typedef struct ListCursor{
+    ListPtr list;
+    ListChunk* prev;    // Chunk before current, NULL at the head
+    ListChunk* current; // Chunk holding the entry under the cursor, NULL past the end
+    int index;          // Position of the entry in current->data
+} ListCursor;
+#else
 typedef struct ListObj{
     NodePtr head;
+    NodePtr tail;
     void (*dataPrinter)(void *data);
     int length;
 } ListObj;
 
 typedef struct ListObj* ListPtr;
 
+// Position in a list for walking it without getList (see beginList)
+typedef struct ListCursor{
+    ListPtr list;
+    NodePtr prev;       // Entry before current, NULL at the head
+    NodePtr current;    // Entry under the cursor, NULL past the end
+} ListCursor;
+#endif
+
 // Constructors-Destructors --------------------------
 
 /**
@@ -77,7 +114,7 @@ void *getList( ListPtr L, int i );
 // Manipulation functions ----------------------------
 
 /**
- * @brief Appends an entry to the list.
+ * @brief Appends an entry to the list in constant time.
  * 
  * @param	L	The list to append to
  * @param	data	The data to add as new entry in list
@@ -86,6 +123,17 @@ void *getList( ListPtr L, int i );
 bool appendList( ListPtr L, void *data );
 
 
+/**
+ * @brief Appends n entries to the list in one step, in order. Either all of them are added or none are.
+ * 
+ * @param	L	The list to append to
+ * @param	data	The data to add, one new entry per element
+ * @param	n	The number of entries to add
+ * @return	bool	True if successful append, False otherwise
+ */
+bool extendList( ListPtr L, void **data, int n );
+
+
 /**
  * @brief Deletes the entry at the specified index and returns the data from that entry.
  * 
@@ -95,4 +143,52 @@ bool appendList( ListPtr L, void *data );
  */
 void *deleteList( ListPtr L, int i );
 
+
+// Cursor functions ----------------------------------
+
+/**
+ * @brief Starts a cursor on the first entry of the list. A cursor walks the list one entry at a time, so
+ * visiting every entry costs O(n) in total where a getList loop costs O(n^2).
+ * 
+ * @param	L	The list to walk
+ * @param	C	The cursor to position
+ */
+void beginList( ListPtr L, ListCursor *C );
+
+
+/**
+ * @brief Checks whether the cursor has moved past the last entry.
+ * 
+ * @param	C	The cursor
+ * @return	bool	True if there is no current entry, False otherwise
+ */
+bool endList( ListCursor *C );
+
+
+/**
+ * @brief Retrieves the data from the entry under the cursor.
+ * 
+ * @param	C	The cursor
+ * @return	void*	The data of the current entry. Returns NULL at the end of the list.
+ */
+void *currentList( ListCursor *C );
+
+
+/**
+ * @brief Moves the cursor to the next entry.
+ * 
+ * @param	C	The cursor to advance
+ */
+void nextList( ListCursor *C );
+
+
+/**
+ * @brief Deletes the entry under the cursor in constant time and returns its data. The cursor moves on to
+ * the entry that followed it. Other cursors on the same list must not be used afterwards.
+ * 
+ * @param	C	The cursor
+ * @return	void*	The data that was stored in that entry. Returns NULL at the end of the list.
+ */
+void *deleteCurrentList( ListCursor *C );
+
 #endif
\ No newline at end of file
@@ -1,7 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "Dictionary.h"
+#include "TypedDictionary.h"
+#include "FrozenDictionary.h"
+#include "NodePool.h"
 
 #define MAX_LINE_LEN 1024 // Maximum length of a line read from file or stdin
 #define MAX_TOKEN_LEN 64  // Maximum length of a token (word or subword)
@@ -20,17 +24,22 @@ Sentence corpus[1000];
 int corpus_size = 0;
 
 // Global dictionaries:
-// - token_to_id: maps token (string) → token ID (string)
-Dictionary *token_to_id;
+// - token_to_id: maps token (string) → token ID (stored inline as uint32)
+StrU32Dict *token_to_id;
 int next_token_id = 0;  // Counter to assign unique token IDs
 
 /**
- * @brief Prints a key-value pair in the format "key: value".
+ * @brief Prints the vocabulary as "token: id" lines, in hash table order.
  *
- * @param data Pointer to the KVPair to print.
+ * @param vocabulary Dictionary mapping tokens to IDs.
  */
-void print_KVPair(void *data) {
-    printf("%s: %s\n", ((KVPair *)data)->key, (char*)((KVPair *)data)->value);
+void print_vocabulary(StrU32Dict *vocabulary) {
+    StrU32DictIter it;
+    StrU32DictEntry *entry;
+    str_u32_dict_iter_begin(vocabulary, &it);
+    while ((entry = str_u32_dict_iter_next(&it)) != NULL) {
+        printf("%s: %u\n", str_u32_dict_key(vocabulary, entry), entry->value);
+    }
 }
 
 /**
@@ -40,24 +49,36 @@ void print_KVPair(void *data) {
  * @param token The token string to add.
  */
 void add_token(char *token) {
-    // Check if the token is already present
-    if (dictionary_find(token_to_id, token) != NULL)
+    // Look up the token and create its entry in a single probe
+    bool inserted;
+    uint32_t *id = str_u32_dict_upsert(token_to_id, token, &inserted);
+    if (!inserted)
         return;
 
-    // Convert the current ID counter to string
-    char *id_str = malloc(16);
-    sprintf(id_str, "%d", next_token_id);
-
-    // Insert token → ID mapping
-    char *token_copy = strdup(token);
-    KVPair *fwd = malloc(sizeof(KVPair));
-    fwd->key = strdup(token_copy);
-    fwd->value = strdup(id_str);
-    dictionary_insert(token_to_id, fwd);
+    // Fill in token → ID mapping (no string or allocation needed)
+    *id = next_token_id;
 
     next_token_id++;  // Increment the next available ID
 }
 
+/**
+ * @brief Gets the number of a token for find_best_pair, numbering it if it is new.
+ *
+ * @param numbers Dictionary mapping tokens to their numbers (stored in the value pointer).
+ * @param next_number The number to give the next new token; incremented when it is used.
+ * @param token The token string.
+ * @return uint32_t The token's number, or UINT32_MAX on allocation failure.
+ */
+uint32_t token_number(Dictionary *numbers, uint32_t *next_number, char *token) {
+    bool inserted;
+    KVPair *entry = dictionary_upsert(numbers, token, &inserted);
+    if (entry == NULL) return UINT32_MAX;
+    if (inserted) {
+        entry->value = (void *)(intptr_t)(*next_number)++;
+    }
+    return (uint32_t)(intptr_t)entry->value;
+}
+
 /**
  * 
  * @brief Finds the most frequent adjacent token pair in the corpus.
@@ -78,51 +99,40 @@ void add_token(char *token) {
  * @return int The frequency count of the most frequent pair.
  */
 int find_best_pair(Sentence corpus[], int corpus_size, char* best_left, char* best_right) {
-    // Create a temporary dictionary to count pair frequencies
-    Dictionary *pair_counts = dictionary_create(101, NULL);
+    // Create temporary dictionaries to count pair frequencies. Every distinct token is numbered the
+    // first time it is seen, and a pair is counted under its two numbers packed into one uint64, so
+    // no pair string is built and the count sits inline in the entry. Both are rebuilt on every
+    // iteration; the token numbers are carved from an arena and freed in one go.
+    Dictionary *token_numbers = dictionary_create_ex(101, NULL, DICT_ARENA);
+    uint32_t next_number = 0;
+    U64U32Dict *pair_counts = u64_u32_dict_create(101);
     int max_count = 0;
     
     // First pass: count all adjacent pairs
     for (int i = 0; i < corpus_size; i++) {
         for (int j = 0; j < corpus[i].token_count - 1; j++) {
             // Create a key for this pair
-            char pair_key[MAX_TOKEN_LEN * 2 + 1];
-            sprintf(pair_key, "%s %s", corpus[i].tokens[j], corpus[i].tokens[j + 1]);
+            uint32_t left = token_number(token_numbers, &next_number, corpus[i].tokens[j]);
+            uint32_t right = token_number(token_numbers, &next_number, corpus[i].tokens[j + 1]);
+            if (left == UINT32_MAX || right == UINT32_MAX) continue;
             
-            // Check if this pair is already counted
-            KVPair *existing = dictionary_find(pair_counts, pair_key);
-            if (existing) {
-                // Increment count
-                int count = atoi((char*)existing->value) + 1;
-                char count_str[16];
-                sprintf(count_str, "%d", count);
-                existing->value = strdup(count_str);
-                
-                // Update max if needed
-                if (count > max_count) {
-                    max_count = count;
-                    strcpy(best_left, corpus[i].tokens[j]);
-                    strcpy(best_right, corpus[i].tokens[j + 1]);
-                }
-            } else {
-                // Add new pair with count 1
-                KVPair *new_pair = malloc(sizeof(KVPair));
-                new_pair->key = strdup(pair_key);
-                new_pair->value = strdup("1");
-                dictionary_insert(pair_counts, new_pair);
-                
-                // Update max if this is the first pair
-                if (max_count == 0) {
-                    max_count = 1;
-                    strcpy(best_left, corpus[i].tokens[j]);
-                    strcpy(best_right, corpus[i].tokens[j + 1]);
-                }
+            // Get this pair's counter, creating it (at zero) on first sight
+            uint32_t *count = u64_u32_dict_upsert(pair_counts, (uint64_t)left << 32 | right, NULL);
+            if (count == NULL) continue;
+            (*count)++;
+            
+            // Update max if needed (the first pair seen becomes the initial best)
+            if ((int)*count > max_count) {
+                max_count = (int)*count;
+                strcpy(best_left, corpus[i].tokens[j]);
+                strcpy(best_right, corpus[i].tokens[j + 1]);
             }
         }
     }
     
     // Clean up
-    dictionary_destroy(pair_counts);
+    u64_u32_dict_destroy(pair_counts);
+    dictionary_destroy(token_numbers);
     return max_count;
 }
 
@@ -217,14 +227,14 @@ void bpe_train(Sentence corpus[], int corpus_size, int max_iter) {
  * 1. For each word in the input:
  *    a. Append </w> to mark end of word.
  *    b. Scan from left to right:
- *       - Greedily find the longest matching token using dictionary_find().
+ *       - Greedily find the longest matching token, looking all candidate lengths up at once with frozen_dictionary_find_many().
  *       - If no match, treat as unknown character and fallback for unknown single character. e.g. printf("[UNK(%s)] ", fallback);
  *    c. Print the matched token and its ID (or UNK). e.g. printf("Word '%s': ", word); printf("[%s -> %s] ", matched_token, (char*)matched_kv->value);
  *
  * @param input Input sentence string.
- * @param token_to_id Dictionary mapping tokens to IDs.
+ * @param vocab Frozen dictionary mapping tokens to IDs.
  */
-void greedy_bpe_tokenize(char *input, Dictionary *token_to_id) {
+void greedy_bpe_tokenize(char *input, FrozenDictionary *vocab) {
     char *word = strtok(input, " \n");
     while (word) {
         printf("Word '%s': ", word);
@@ -237,28 +247,32 @@ void greedy_bpe_tokenize(char *input, Dictionary *token_to_id) {
         // Greedy matching from left to right
         int pos = 0;
         while (pos < len) {
-            // Try to find the longest matching token
-            int best_match_len = 0;
-            char best_match[MAX_TOKEN_LEN] = "";
+            // Every prefix starting at pos is a candidate (no token is longer than MAX_TOKEN_LEN - 1)
+            int max_len = len - pos < MAX_TOKEN_LEN - 1 ? len - pos : MAX_TOKEN_LEN - 1;
+            char candidates[MAX_TOKEN_LEN - 1][MAX_TOKEN_LEN];
+            char *keys[MAX_TOKEN_LEN - 1];
+            uint32_t found[MAX_TOKEN_LEN - 1];
             
-            // Try all possible lengths from current position
-            for (int match_len = 1; match_len <= len - pos; match_len++) {
-                char candidate[MAX_TOKEN_LEN];
-                strncpy(candidate, word_with_marker + pos, match_len);
-                candidate[match_len] = '\0';
-                
-                // Check if this token exists in vocabulary
-                KVPair *kv = dictionary_find(token_to_id, candidate);
-                if (kv) {
+            for (int match_len = 1; match_len <= max_len; match_len++) {
+                strncpy(candidates[match_len - 1], word_with_marker + pos, match_len);
+                candidates[match_len - 1][match_len] = '\0';
+                keys[match_len - 1] = candidates[match_len - 1];
+            }
+            
+            // Look all candidates up in one batch and keep the longest one in the vocabulary
+            frozen_dictionary_find_many(vocab, keys, max_len, found);
+            
+            int best_match_len = 0;
+            for (int match_len = max_len; match_len >= 1; match_len--) {
+                if (found[match_len - 1] != FROZEN_MISSING) {
                     best_match_len = match_len;
-                    strcpy(best_match, candidate);
+                    break;
                 }
             }
             
             if (best_match_len > 0) {
                 // Found a match
-                KVPair *kv = dictionary_find(token_to_id, best_match);
-                printf("[%s -> %s] ", best_match, (char*)kv->value);
+                printf("[%s -> %u] ", candidates[best_match_len - 1], found[best_match_len - 1]);
                 pos += best_match_len;
             } else {
                 // No match found, treat as unknown character
@@ -294,7 +308,7 @@ int main(int argc, char **argv) {
     }
 
     // Initialize dictionaries
-    token_to_id = dictionary_create(101, print_KVPair);
+    token_to_id = str_u32_dict_create(101);
 
     char line[MAX_LINE_LEN];
 
@@ -328,18 +342,35 @@ int main(int argc, char **argv) {
         }
     }
 
+    // The vocabulary is final: freeze it for single-probe lookups while tokenizing
+    FrozenDictionary *vocab = frozen_dictionary_create(token_to_id);
+    if (!vocab) {
+        printf("Failed to freeze the vocabulary\n");
+        return 1;
+    }
+
     printf("\nVocabulary:\n");
-    dictionary_print(token_to_id);
+    print_vocabulary(token_to_id);
+
+    // Dump hash table health (build with -DDEBUG)
+    #ifdef DEBUG
+    DictStats stats;
+    str_u32_dict_stats(token_to_id, &stats);
+    printf("\ntoken_to_id stats:\n");
+    dictionary_stats_print(&stats);
+    #endif
 
     // Step 4: Process user input for BPE tokenization
     printf("\nEnter sentence to tokenize (or Ctrl+D to exit):\n");
     while (fgets(line, sizeof(line), stdin)) {
         line[strcspn(line, "\n")] = 0;  // Remove newline character
-        greedy_bpe_tokenize(line, token_to_id);
+        greedy_bpe_tokenize(line, vocab);
     }
 
     // Clean up
-    dictionary_destroy(token_to_id);
+    frozen_dictionary_destroy(vocab);
+    str_u32_dict_destroy(token_to_id);
+    nodePoolDestroy();  // Every list is gone: release the node slabs
 
     return 0;
 }